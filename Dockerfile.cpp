@@ -13,7 +13,8 @@ RUN apt-get update && apt-get install -y \
 WORKDIR /build
 
 # Copy source files
-COPY bot.cpp .
+COPY *.cpp *.h ./
+COPY bench/ bench/
 COPY CMakeLists.txt .
 
 # Build the bot
@@ -33,8 +34,9 @@ RUN apt-get update && apt-get install -y \
 # Create app directory
 WORKDIR /app
 
-# Copy the built executable
+# Copy the built executables (translator-coordinator is for cluster mode)
 COPY --from=builder /build/build/bin/discord-bot .
+COPY --from=builder /build/build/bin/translator-coordinator .
 
 # Copy .env file will be mounted as volume
 VOLUME ["/app"]
@@ -0,0 +1,41 @@
+#include "auto_translate.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "languages.h"
+#include "text_masker.h"
+#include "text_scanner.h"
+
+bool prepare_auto_translate(const std::string& content, std::string& cleaned) {
+    TextScan scan = scan_text(content);
+    if (scan.url_only || scan.non_space_chars == 0) {
+        return false;
+    }
+    // Nothing left once code, links, mentions and numbers are set aside
+    if (scan_text(mask_spans(scan.cleaned).text).letters() == 0) {
+        return false;
+    }
+    cleaned = std::move(scan.cleaned);
+    return true;
+}
+
+ReplyText::ReplyText(std::vector<std::string> target_langs) : target_langs_(std::move(target_langs)) {}
+
+const std::string& ReplyText::add(const Translation& translation) {
+    std::string upper_code = translation.target_lang;
+    std::transform(upper_code.begin(), upper_code.end(), upper_code.begin(), ::toupper);
+    std::string& line = lines_[translation.target_lang];
+    line = language_flag(translation.target_lang);
+    line += " **" + upper_code + ":** " + translation.text.substr(0, 500) + "\n";
+
+    // Keep the configured target order no matter which request finished first
+    description_.clear();
+    for (const auto& target_lang : target_langs_) {
+        auto it = lines_.find(target_lang);
+        if (it != lines_.end()) {
+            description_ += it->second;
+        }
+    }
+    return description_;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "translator.h"
+
+// Text of a message to auto-translate with emoji and custom emotes removed.
+// Returns false for messages not worth translating (only links, emoji,
+// mentions, code or numbers).
+bool prepare_auto_translate(const std::string& content, std::string& cleaned);
+
+// Description of an auto-translate reply, rebuilt as translations arrive so
+// the lines always follow the configured target order
+class ReplyText {
+public:
+    explicit ReplyText(std::vector<std::string> target_langs);
+
+    // Add a translation and return the full description
+    const std::string& add(const Translation& translation);
+
+    const std::string& description() const { return description_; }
+
+private:
+    std::vector<std::string> target_langs_;
+    std::map<std::string, std::string> lines_;
+    std::string description_;
+};
@@ -0,0 +1,120 @@
+// Accuracy and latency benchmark for the in-process language detector.
+//
+// Usage: langid-bench [corpus.tsv]
+// The corpus holds one "<code>\t<text>" pair per line; '#' starts a comment.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "language_detector.h"
+
+struct Sample {
+    std::string code;
+    std::string text;
+};
+
+struct Result {
+    std::string expected;
+    LanguageGuess guess;
+    double micros;
+};
+
+static const int ITERATIONS = 50;
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "bench/langid_corpus.tsv";
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open corpus: " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<Sample> samples;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) {
+            continue;
+        }
+        samples.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+
+    // Build the profiles before timing anything
+    auto build_start = std::chrono::steady_clock::now();
+    detect_language_local("warm up");
+    double build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+
+    std::vector<Result> results;
+    for (const auto& sample : samples) {
+        LanguageGuess guess;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            guess = detect_language_local(sample.text);
+        }
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+        results.push_back({sample.code, guess, micros});
+    }
+
+    std::map<std::string, std::pair<int, int>> per_language;  // correct, total
+    for (const auto& r : results) {
+        auto& counts = per_language[r.expected];
+        counts.first += r.guess.code == r.expected;
+        counts.second += 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Corpus: " << results.size() << " samples, " << per_language.size() << " languages" << std::endl;
+    std::cout << "Profile build: " << build_ms << " ms" << std::endl << std::endl;
+
+    int correct = 0;
+    std::cout << "Accuracy by language:" << std::endl;
+    for (const auto& [code, counts] : per_language) {
+        correct += counts.first;
+        std::cout << "  " << std::left << std::setw(6) << code << std::right
+                  << std::setw(3) << counts.first << "/" << counts.second << std::endl;
+    }
+
+    for (const auto& r : results) {
+        if (r.guess.code != r.expected) {
+            std::cout << "  miss: expected " << r.expected << ", got " << (r.guess.code.empty() ? "-" : r.guess.code)
+                      << " (" << std::setprecision(2) << r.guess.confidence << std::setprecision(1) << ")" << std::endl;
+        }
+    }
+
+    std::cout << std::endl << "Overall accuracy: " << 100.0 * correct / results.size() << "%" << std::endl << std::endl;
+
+    std::cout << "Confidence threshold (local answer rate / accuracy of local answers):" << std::endl;
+    for (float threshold : {0.5f, 0.7f, 0.8f, 0.9f, 0.95f}) {
+        int answered = 0;
+        int answered_correct = 0;
+        for (const auto& r : results) {
+            if (!r.guess.code.empty() && r.guess.confidence >= threshold) {
+                ++answered;
+                answered_correct += r.guess.code == r.expected;
+            }
+        }
+        std::cout << "  >= " << std::setprecision(2) << threshold << std::setprecision(1) << ": "
+                  << 100.0 * answered / results.size() << "% / "
+                  << (answered ? 100.0 * answered_correct / answered : 0.0) << "%" << std::endl;
+    }
+
+    std::vector<double> latencies;
+    for (const auto& r : results) {
+        latencies.push_back(r.micros);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+
+    std::cout << std::endl << std::setprecision(2) << "Latency per detection: p50 " << percentile(0.50)
+              << " us, p95 " << percentile(0.95) << " us, p99 " << percentile(0.99)
+              << " us, max " << latencies.back() << " us" << std::endl;
+    return 0;
+}
@@ -0,0 +1,209 @@
+// Allocation and latency benchmark for the translate request/response path.
+//
+// Usage: response-bench [corpus.tsv] [iterations]
+// For every corpus text, builds the form body of a translate request and
+// parses a translate_a/single response like the one Google sends back, once
+// the way the bot used to (ostringstream encoder, a fresh response string,
+// a full JSON document) and once the way it does now (table-driven encoder
+// into a reused buffer, a recycled response buffer, the streaming extractor).
+// Reports heap allocations and time per message for each step.
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "json_cursor.h"
+#include "translator.h"
+
+using json = nlohmann::json;
+
+// Curl hands the body over in pieces of up to this many bytes
+static const size_t WRITE_CHUNK = 1024;
+
+// The encoder the bot used before url_encode_into
+static std::string stream_encode(const std::string& value) {
+    std::ostringstream escaped;
+    escaped.fill('0');
+    escaped << std::hex;
+    for (char c : value) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            escaped << c;
+        } else {
+            escaped << std::uppercase << '%' << std::setw(2) << int((unsigned char)c) << std::nouppercase;
+        }
+    }
+    return escaped.str();
+}
+
+// The parser the bot used before extract_google_translation
+static bool dom_parse(const std::string& body, std::string& translated, std::string& detected) {
+    auto j = json::parse(body);
+    if (!j.is_array() || j.empty()) {
+        return false;
+    }
+    if (j.size() > 2 && j[2].is_string()) {
+        detected = j[2].get<std::string>();
+    }
+    if (j[0].is_array()) {
+        for (const auto& segment : j[0]) {
+            if (segment.is_array() && !segment.empty() && segment[0].is_string()) {
+                translated += segment[0].get<std::string>();
+            }
+        }
+    }
+    return true;
+}
+
+// A response shaped like translate_a/single's, one segment per sentence
+static std::string google_response(const std::string& text) {
+    json segments = json::array();
+    std::istringstream sentences(text);
+    std::string sentence;
+    while (std::getline(sentences, sentence, '.')) {
+        segments.push_back({sentence + ".", sentence + ".", nullptr, nullptr, 10});
+    }
+    json response = {segments, nullptr, "en", nullptr, nullptr, nullptr, 1.0, json::array(),
+                     {{"en"}, nullptr, {1.0}, {"en"}}};
+    return response.dump();
+}
+
+// Per-message averages
+struct Step {
+    double allocations = 0.0;
+    double nanos = 0.0;
+};
+
+template <typename Function>
+static Step measure(size_t iterations, size_t messages, Function function) {
+    uint64_t before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        function();
+    }
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double count = static_cast<double>(iterations * messages);
+    return {(allocations.load() - before) / count, nanos / count};
+}
+
+static void print_step(const char* name, const Step& before, const Step& after) {
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(10) << before.allocations << std::setw(10) << after.allocations
+              << std::setw(12) << before.nanos << std::setw(12) << after.nanos << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "bench/langid_corpus.tsv";
+    size_t iterations = argc > 2 ? std::stoul(argv[2]) : 200;
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open corpus: " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> texts;
+    std::vector<std::string> responses;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) {
+            continue;
+        }
+        texts.push_back(line.substr(tab + 1));
+        responses.push_back(google_response(texts.back()));
+    }
+    if (texts.empty()) {
+        std::cerr << "Corpus is empty: " << path << std::endl;
+        return 1;
+    }
+
+    // Both parsers must agree before their speed means anything
+    for (const auto& response : responses) {
+        std::string a, b, lang_a, lang_b;
+        if (!dom_parse(response, a, lang_a) || !extract_google_translation(response, b, lang_b) || a != b ||
+            lang_a != lang_b) {
+            std::cerr << "Parsers disagree on: " << response << std::endl;
+            return 1;
+        }
+    }
+
+    const size_t n = texts.size();
+    size_t sink = 0;
+
+    Step encode_before = measure(iterations, n, [&] {
+        for (const auto& text : texts) {
+            std::string body = "q=" + stream_encode(text);
+            sink += body.size();
+        }
+    });
+    std::string body;
+    Step encode_after = measure(iterations, n, [&] {
+        for (const auto& text : texts) {
+            body.assign("q=");
+            url_encode_into(body, text);
+            sink += body.size();
+        }
+    });
+
+    Step receive_before = measure(iterations, n, [&] {
+        for (const auto& response : responses) {
+            std::string received;
+            for (size_t pos = 0; pos < response.size(); pos += WRITE_CHUNK) {
+                received.append(response, pos, WRITE_CHUNK);
+            }
+            sink += received.size();
+        }
+    });
+    std::string received;
+    Step receive_after = measure(iterations, n, [&] {
+        for (const auto& response : responses) {
+            received.clear();
+            for (size_t pos = 0; pos < response.size(); pos += WRITE_CHUNK) {
+                received.append(response, pos, WRITE_CHUNK);
+            }
+            sink += received.size();
+        }
+    });
+
+    Step parse_before = measure(iterations, n, [&] {
+        for (const auto& response : responses) {
+            std::string translated, detected;
+            dom_parse(response, translated, detected);
+            sink += translated.size();
+        }
+    });
+    Step parse_after = measure(iterations, n, [&] {
+        for (const auto& response : responses) {
+            std::string translated, detected;
+            translated.reserve(response.size() / 2);
+            extract_google_translation(response, translated, detected);
+            sink += translated.size();
+        }
+    });
+
+    auto total = [](const Step& a, const Step& b, const Step& c) {
+        return Step{a.allocations + b.allocations + c.allocations, a.nanos + b.nanos + c.nanos};
+    };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << n << " messages x " << iterations << " iterations" << std::endl << std::endl;
+    std::cout << "              allocations/msg        ns/msg" << std::endl;
+    std::cout << "                before     after      before       after" << std::endl;
+    print_step("encode", encode_before, encode_after);
+    print_step("receive", receive_before, receive_after);
+    print_step("parse", parse_before, parse_after);
+    print_step("total", total(encode_before, receive_before, parse_before),
+               total(encode_after, receive_after, parse_after));
+
+    return sink == 0;
+}
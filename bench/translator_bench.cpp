@@ -0,0 +1,405 @@
+// End-to-end benchmark of the auto-translate pipeline.
+//
+// Usage: translator-bench [corpus.tsv] [messages] [targets]
+// Replays the corpus (one "<code>\t<text>" pair per line, as in
+// langid_corpus.tsv) as message_create events spread over a few channels,
+// and pushes each one through the same steps as the bot's on_message_create
+// handler: settings lookup, cleaning, the guild scheduler, the worker pool, detection and
+// translation, building the reply text and the reply dispatcher. Nothing
+// talks to Discord: replies go to a fake that confirms each REST call after
+// BENCH_DISCORD_LATENCY_MS (default 100), and the translation backend
+// defaults to the in-process mock.
+//
+// Everything else is configured through the environment like the bot, so
+// configurations can be compared directly, e.g.
+//   CACHE_MAX_BYTES=0 WORKER_THREADS=4 ./build/bin/translator-bench
+// BENCH_RATE (messages per second, default 0 = as fast as the queue allows)
+// sets the offered load, BENCH_MAX_IN_FLIGHT (default 1000) caps how many
+// messages may be waiting on translations at once, and BENCH_GUILDS
+// (default 1) spreads the messages over that many guilds. With
+// COORDINATOR_SOCKET set the bench joins a running coordinator daemon, so
+// several benches started together measure cluster mode.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "auto_translate.h"
+#include "config.h"
+#include "coordinator.h"
+#include "event_loop.h"
+#include "guild_scheduler.h"
+#include "reply_dispatcher.h"
+#include "settings_store.h"
+#include "translation_cache.h"
+#include "translation_backend.h"
+#include "translator.h"
+#include "upstream_governor.h"
+#include "worker_pool.h"
+
+struct FakeEvent {
+    uint64_t channel_id;
+    uint64_t guild_id;
+    std::string content;
+};
+
+static const uint64_t FIRST_GUILD_ID = 1000;
+static const uint64_t CHANNEL_COUNT = 8;
+
+// Stands in for Discord, answering each REST call after a fixed latency
+class FakeReplySink : public ReplySink {
+public:
+    explicit FakeReplySink(std::chrono::milliseconds latency) : latency_(latency) {}
+
+    void create(uint64_t, const ReplyPage&, std::function<void(uint64_t reply_id)> done) override {
+        uint64_t id = ++calls_ + (1ull << 40);
+        answer([done, id] { done(id); });
+    }
+
+    void edit(uint64_t, uint64_t, const ReplyPage&, std::function<void(bool ok)> done) override {
+        ++calls_;
+        answer([done] { done(true); });
+    }
+
+    void remove(uint64_t, uint64_t) override {
+        ++calls_;
+    }
+
+    uint64_t calls() const { return calls_; }
+
+    // No call for at least quiet and none awaiting an answer
+    bool idle(std::chrono::steady_clock::duration quiet) const {
+        auto last = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(last_call_.load()));
+        return outstanding_ == 0 && std::chrono::steady_clock::now() - last >= quiet;
+    }
+
+private:
+    void answer(std::function<void()> done) {
+        ++outstanding_;
+        last_call_ = std::chrono::steady_clock::now().time_since_epoch().count();
+        event_loop().post_after(latency_, [this, done] {
+            done();
+            --outstanding_;
+        });
+    }
+
+    const std::chrono::milliseconds latency_;
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> outstanding_{0};
+    std::atomic<std::chrono::steady_clock::rep> last_call_{0};
+};
+
+// Per-stage samples in microseconds
+struct Samples {
+    std::mutex mutex;
+    std::vector<double> clean;
+    std::vector<double> detect;
+    std::vector<double> translate;
+    std::vector<double> embed;
+    std::vector<double> total;
+};
+
+static double micros_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void print_stage(const char* name, std::vector<double>& values) {
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](double p) {
+        return values.empty() ? 0.0 : values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+    };
+    std::cout << "  " << std::left << std::setw(12) << name << std::right
+              << std::setw(12) << percentile(0.50)
+              << std::setw(12) << percentile(0.95)
+              << std::setw(12) << percentile(0.99) << std::endl;
+}
+
+// The cache must not hand one text's translation to another that only looks
+// alike once whitespace is collapsed; the numbers would flatter it otherwise
+static bool cache_keys_distinct() {
+    TranslationCache cache(1 << 16, std::chrono::seconds(60), 1);
+    cache.put("a\nb", "en", "es", "multi-line");
+    std::string value;
+    return !cache.get("a b", "en", "es", value) && cache.get(" a \n b ", "en", "es", value);
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "bench/langid_corpus.tsv";
+    size_t message_count = argc > 2 ? std::stoul(argv[2]) : 2000;
+    std::string target_list = argc > 3 ? argv[3] : "en,es,de";
+
+    // Never reach a real service unless asked to, and don't let the upstream
+    // rate limit dominate the numbers unless one is set explicitly
+    setenv("TRANSLATION_BACKEND", "mock", 0);
+    setenv("UPSTREAM_MAX_RATE", "100000", 0);
+    // Likewise for the per-guild limits, which one busy guild would hit
+    setenv("SCHEDULER_MAX_IN_FLIGHT", "100000", 0);
+    setenv("GUILD_MAX_IN_FLIGHT", "100000", 0);
+    setenv("GUILD_MAX_QUEUED", "100000", 0);
+    load_config(".env");
+
+    if (!cache_keys_distinct()) {
+        std::cerr << "Translation cache merges texts that differ in their line breaks" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open corpus: " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> texts;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) {
+            continue;
+        }
+        texts.push_back(line.substr(tab + 1));
+    }
+    if (texts.empty()) {
+        std::cerr << "Corpus is empty: " << path << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> targets;
+    std::istringstream target_stream(target_list);
+    while (std::getline(target_stream, line, ',')) {
+        targets.push_back(line);
+    }
+
+    const uint64_t guild_count = std::max<long>(config_int("BENCH_GUILDS", 1), 1);
+
+    // Fake event source: the corpus repeated until message_count, round robin over channels and guilds
+    std::vector<FakeEvent> events;
+    for (size_t i = 0; i < message_count; ++i) {
+        events.push_back({100 + i % CHANNEL_COUNT, FIRST_GUILD_ID + i % guild_count, texts[i % texts.size()]});
+    }
+
+    // With COORDINATOR_SOCKET set this is one process of a cluster: start the
+    // coordinator daemon, then several benches at once and add up their throughput
+    SettingsStore settings_store("");
+    std::unique_ptr<SocketCoordinator> coordinator;
+    std::string coordinator_socket = config_string("COORDINATOR_SOCKET");
+    if (!coordinator_socket.empty()) {
+        coordinator = std::make_unique<SocketCoordinator>(coordinator_socket, std::chrono::milliseconds(200));
+        coordinator->join(translation_cache(), settings_store);
+        if (!coordinator->wait_synced(std::chrono::seconds(5))) {
+            std::cerr << "Cannot reach the coordinator at " << coordinator_socket << std::endl;
+            return 1;
+        }
+    }
+    for (uint64_t g = 0; g < guild_count; ++g) {
+        settings_store.set_server(FIRST_GUILD_ID + g, targets);
+    }
+
+    const size_t threads = std::max<long>(config_int("WORKER_THREADS", 4), 1);
+    const size_t capacity = std::max<long>(config_int("WORKER_QUEUE_CAPACITY", 256), 1);
+    const double rate = config_double("BENCH_RATE", 0.0);
+    const size_t max_in_flight = config_int("BENCH_MAX_IN_FLIGHT", 1000);
+
+    // Initialize shared components before timing anything
+    translation_backend();
+    translation_cache();
+    translate_message("warm up", {});
+
+    WorkerPool pool(threads, capacity,
+                    parse_overflow_policy(config_string("WORKER_OVERFLOW_POLICY", "shed_auto_translate")));
+    GuildScheduler scheduler(scheduler_options_from_config());
+
+    DispatcherOptions reply_options = dispatcher_options_from_config();
+    FakeReplySink reply_sink(std::chrono::milliseconds(config_int("BENCH_DISCORD_LATENCY_MS", 100)));
+    ReplyIndex replies(16384, std::chrono::hours(24));
+    auto dispatcher = std::make_shared<ReplyDispatcher>(reply_sink, replies, reply_options);
+
+    Samples samples;
+    std::mutex in_flight_mutex;
+    std::condition_variable in_flight_cv;
+    size_t in_flight = 0;
+    size_t peak_in_flight = 0;
+    size_t queued = 0;
+    size_t skipped = 0;
+    std::atomic<uint64_t> dropped{0};
+
+    auto finish = [&]() {
+        std::lock_guard<std::mutex> lock(in_flight_mutex);
+        --in_flight;
+        in_flight_cv.notify_one();
+    };
+
+    uint64_t allocations_before = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (rate > 0) {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(static_cast<int64_t>(i * 1e6 / rate)));
+        } else {
+            // Without a target rate, keep the pipeline full but never overflow the queue
+            std::unique_lock<std::mutex> lock(in_flight_mutex);
+            in_flight_cv.wait(lock, [&] { return in_flight < max_in_flight && queued < capacity; });
+        }
+
+        const FakeEvent& event = events[i];
+        ReplyOrigin origin{i + 1, event.channel_id, event.guild_id, 0};
+        auto received = std::chrono::steady_clock::now();
+
+        // Same steps as on_message_create
+        std::shared_ptr<const Settings> settings = settings_store.snapshot();
+        const std::vector<std::string>* found = settings->targets_for(event.channel_id, event.guild_id);
+        if (!found || found->empty()) {
+            ++skipped;
+            continue;
+        }
+        const std::vector<std::string>& target_langs = *found;
+
+        std::string cleaned;
+        bool translatable = prepare_auto_translate(event.content, cleaned);
+        double clean_us = micros_since(received);
+        if (!translatable) {
+            ++skipped;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(in_flight_mutex);
+            peak_in_flight = std::max(peak_in_flight, ++in_flight);
+        }
+
+        auto drop = [&]() {
+            ++dropped;
+            finish();
+        };
+
+        auto cost = static_cast<uint32_t>(target_langs.size());
+        bool accepted = scheduler.submit(event.guild_id, cost, [&, origin, cleaned, target_langs, received, clean_us, drop](GuildScheduler::Done done) {
+            {
+                std::lock_guard<std::mutex> lock(in_flight_mutex);
+                ++queued;
+            }
+
+            pool.submit(TaskClass::AutoTranslate, [&, origin, cleaned, target_langs, received, clean_us, done]() {
+                {
+                    std::lock_guard<std::mutex> lock(in_flight_mutex);
+                    --queued;
+                    in_flight_cv.notify_one();
+                }
+
+                struct Reply {
+                    ReplyText text;
+                    double embed_us = 0.0;
+                    explicit Reply(const std::vector<std::string>& targets) : text(targets) {}
+                };
+                auto reply = std::make_shared<Reply>(target_langs);
+
+                translate_sentences_async(cleaned, "", target_langs, [reply, &dispatcher, origin](const std::string& source_lang, const Translation& translation) {
+                    auto embed_start = std::chrono::steady_clock::now();
+                    dispatcher->update(origin, source_lang, reply->text.add(translation));
+                    reply->embed_us += micros_since(embed_start);
+                }, [&, reply, received, clean_us, done](MessageTranslation& result) {
+                    double total_us = micros_since(received);
+                    {
+                        std::lock_guard<std::mutex> lock(samples.mutex);
+                        samples.clean.push_back(clean_us);
+                        samples.detect.push_back(result.detect_time.count());
+                        samples.translate.push_back(result.translate_time.count());
+                        samples.embed.push_back(reply->embed_us);
+                        samples.total.push_back(total_us);
+                    }
+                    done();
+                    finish();
+                });
+            }, [&, drop, done]() {
+                {
+                    std::lock_guard<std::mutex> lock(in_flight_mutex);
+                    --queued;
+                }
+                done();
+                drop();
+            });
+        }, drop);
+        if (!accepted) {
+            drop();
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(in_flight_mutex);
+        in_flight_cv.wait(lock, [&] { return in_flight == 0; });
+    }
+    double seconds = micros_since(start) / 1e6;
+    uint64_t allocated = allocations.load() - allocations_before;
+    pool.shutdown();
+
+    // Let the last windows close and their replies be confirmed
+    while (dispatcher->stats().pending > 0 || !reply_sink.idle(reply_options.window * 2)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    DispatcherStats dispatched = dispatcher->stats();
+
+    size_t processed = samples.total.size();
+    CacheStats cache = translation_cache().stats();
+    BatchStats batch = translation_batch_stats();
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Backend: " << translation_backend().name() << ", " << threads << " threads + event loop, queue " << capacity
+              << ", cache " << config_int("CACHE_MAX_BYTES", 32 * 1024 * 1024) << " bytes, batching "
+              << (config_bool("BATCH_ENABLED", false) ? "on" : "off") << std::endl;
+    std::cout << "Messages: " << events.size() << " sent, " << processed << " translated, " << skipped
+              << " skipped, " << dropped.load() << " dropped" << std::endl;
+    std::cout << "Throughput: " << processed / seconds << " msg/s over " << seconds << " s, peak "
+              << peak_in_flight << " in flight" << std::endl << std::endl;
+
+    std::cout << "Latency (us)        p50         p95         p99" << std::endl;
+    print_stage("clean", samples.clean);
+    print_stage("detect", samples.detect);
+    print_stage("translate", samples.translate);
+    print_stage("embed", samples.embed);
+    print_stage("end-to-end", samples.total);
+
+    std::cout << std::endl << "Allocations per message: " << (processed ? static_cast<double>(allocated) / processed : 0.0)
+              << std::endl;
+    std::cout << "Cache: " << cache.hits << " hits, " << cache.misses << " misses" << std::endl;
+    if (batch.batches > 0) {
+        std::cout << "Batching: " << batch.batches << " batches, fill " << std::setprecision(2) << batch.fill_ratio
+                  << std::setprecision(1) << std::endl;
+    }
+    SchedulerStats scheduled = scheduler.stats();
+    std::cout << "Scheduler: " << guild_count << " guilds, " << scheduled.dispatched << " dispatched, "
+              << scheduled.dropped_quota << " over quota, " << scheduled.dropped_queue_full << " shed from full queues"
+              << std::endl;
+    GovernorStats upstream = upstream_governor().stats();
+    std::cout << "Upstream: " << upstream.admitted << " admitted, " << upstream.rejected << " rejected, "
+              << upstream.retries << " retries, " << upstream.rate_limited << " rate limited, final rate "
+              << upstream.rate << "/s, circuit " << upstream.circuit << ", " << single_flight_saved()
+              << " saved by single-flight" << std::endl;
+    if (coordinator) {
+        CoordinatorStats cluster = coordinator->stats();
+        std::cout << "Coordinator: " << cluster.frames_sent << " frames sent, " << cluster.frames_received
+                  << " received, " << cluster.dropped_puts << " cache entries not shared" << std::endl;
+    }
+    std::cout << "Replies: " << dispatched.created << " messages for " << dispatched.sections << " originals, "
+              << dispatched.edits << " edits, " << dispatched.deferred << " deferred, "
+              << std::setprecision(2) << (processed ? static_cast<double>(reply_sink.calls()) / processed : 0.0)
+              << std::setprecision(1) << " REST calls per message" << std::endl;
+    std::cout << "Peak RSS: " << usage.ru_maxrss / 1024.0 << " MB" << std::endl;
+    return 0;
+}
@@ -1,320 +1,229 @@
 #include <dpp/dpp.h>
-#include <nlohmann/json.hpp>
 #include <curl/curl.h>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <map>
+#include <memory>
 #include <vector>
 #include <string>
-#include <regex>
-#include <thread>
 #include <mutex>
 #include <future>
-
-using json = nlohmann::json;
-
-// Language code mapping
-std::map<std::string, std::string> LANGUAGE_NAMES = {
-    {"english", "en"}, {"spanish", "es"}, {"french", "fr"}, {"german", "de"},
-    {"italian", "it"}, {"portuguese", "pt"}, {"russian", "ru"}, {"japanese", "ja"},
-    {"korean", "ko"}, {"chinese", "zh-CN"}, {"arabic", "ar"}, {"hindi", "hi"},
-    {"dutch", "nl"}, {"polish", "pl"}, {"turkish", "tr"}, {"vietnamese", "vi"},
-    {"thai", "th"}, {"swedish", "sv"}, {"norwegian", "no"}, {"danish", "da"},
-    {"finnish", "fi"}, {"greek", "el"}, {"czech", "cs"}, {"romanian", "ro"},
-    {"hungarian", "hu"}, {"hebrew", "iw"}, {"indonesian", "id"}, {"malay", "ms"},
-    {"filipino", "tl"}, {"ukrainian", "uk"}, {"bengali", "bn"}, {"tamil", "ta"}
-};
-
-std::map<std::string, std::string> LANGUAGE_FLAGS = {
-    {"en", "🇬🇧"}, {"es", "🇪🇸"}, {"fr", "🇫🇷"}, {"de", "🇩🇪"},
-    {"it", "🇮🇹"}, {"pt", "🇵🇹"}, {"ru", "🇷🇺"}, {"ja", "🇯🇵"},
-    {"ko", "🇰🇷"}, {"zh-CN", "🇨🇳"}, {"ar", "🇸🇦"}, {"hi", "🇮🇳"},
-    {"nl", "🇳🇱"}, {"pl", "🇵🇱"}, {"tr", "🇹🇷"}, {"vi", "🇻🇳"},
-    {"th", "🇹🇭"}, {"sv", "🇸🇪"}, {"no", "🇳🇴"}, {"da", "🇩🇰"},
-    {"fi", "🇫🇮"}, {"el", "🇬🇷"}, {"cs", "🇨🇿"}, {"ro", "🇷🇴"},
-    {"hu", "🇭🇺"}, {"iw", "🇮🇱"}, {"id", "🇮🇩"}, {"ms", "🇲🇾"},
-    {"tl", "🇵🇭"}, {"uk", "🇺🇦"}, {"bn", "🇧🇩"}, {"ta", "🇮🇳"}
-};
-
-
-// Settings file
-const std::string SETTINGS_FILE = "bot_settings.json";
-
-// Auto-translate storage
-std::map<dpp::snowflake, std::vector<std::string>> auto_translate_channels;
-std::map<dpp::snowflake, std::vector<std::string>> auto_translate_servers;
-std::map<dpp::snowflake, dpp::snowflake> translation_messages;
-std::mutex settings_mutex;
-
-// Curl write callback
-size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* userp) {
-    userp->append((char*)contents, size * nmemb);
-    return size * nmemb;
-}
-
-// URL encode function
-std::string url_encode(const std::string& value) {
-    std::ostringstream escaped;
-    escaped.fill('0');
-    escaped << std::hex;
-
-    for (char c : value) {
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            escaped << c;
-        } else {
-            escaped << std::uppercase;
-            escaped << '%' << std::setw(2) << int((unsigned char)c);
-            escaped << std::nouppercase;
-        }
-    }
-
-    return escaped.str();
-}
-
-// Clean text for detection (remove emojis)
-std::string clean_text_for_detection(const std::string& text) {
-    std::regex emoji_pattern(
-        "[\\U0001F600-\\U0001F64F\\U0001F300-\\U0001F5FF\\U0001F680-\\U0001F6FF"
-        "\\U0001F1E0-\\U0001F1FF\\U00002500-\\U00002BEF\\U00002702-\\U000027B0"
-        "\\U000024C2-\\U0001F251\\U0001f926-\\U0001f937\\U00010000-\\U0010ffff"
-        "\\u2640-\\u2642\\u2600-\\u2B55\\u200d\\u23cf\\u23e9\\u231a\\ufe0f\\u3030]+");
-
-    std::string cleaned = std::regex_replace(text, emoji_pattern, "");
-
-    // Remove Discord custom emojis
-    std::regex discord_emoji("<a?:[a-zA-Z0-9_]+:[0-9]+>");
-    cleaned = std::regex_replace(cleaned, discord_emoji, "");
-
-    return cleaned.empty() ? text : cleaned;
-}
-
-// Get language code
-std::string get_language_code(const std::string& lang_input) {
-    std::string lower = lang_input;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-
-    // Trim whitespace
-    lower.erase(lower.begin(), std::find_if(lower.begin(), lower.end(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }));
-    lower.erase(std::find_if(lower.rbegin(), lower.rend(), [](unsigned char ch) {
-        return !std::isspace(ch);
-    }).base(), lower.end());
-
-    if (lower.length() == 2 || lower == "zh-cn") {
-        return lower;
-    }
-
-    auto it = LANGUAGE_NAMES.find(lower);
-    if (it != LANGUAGE_NAMES.end()) {
-        return it->second;
-    }
-
-    return "";
-}
-
-// Detect language using Google Translate API
-std::string detect_language(const std::string& text) {
-    std::string cleaned = clean_text_for_detection(text);
-
-    // Check for Chinese characters
-    std::regex chinese_pattern("[\\u4e00-\\u9fff]");
-    std::smatch matches;
-    std::string::const_iterator searchStart(cleaned.cbegin());
-    int chinese_count = 0;
-    while (std::regex_search(searchStart, cleaned.cend(), matches, chinese_pattern)) {
-        chinese_count++;
-        searchStart = matches.suffix().first;
-    }
-
-    if (chinese_count > 0) {
-        int total_chars = std::count_if(cleaned.begin(), cleaned.end(), [](unsigned char c) {
-            return !std::isspace(c);
+#include "auto_translate.h"
+#include "config.h"
+#include "coordinator.h"
+#include "event_loop.h"
+#include "guild_scheduler.h"
+#include "languages.h"
+#include "metrics.h"
+#include "reply_dispatcher.h"
+#include "reply_index.h"
+#include "settings_store.h"
+#include "startup.h"
+#include "translation_backend.h"
+#include "translator.h"
+#include "upstream_governor.h"
+#include "worker_pool.h"
+
+// Discord REST calls made for auto-translate replies
+Histogram message_create_seconds("discord_rest_seconds", "Time until Discord confirmed a REST call", "call=\"message_create\"");
+Histogram message_edit_seconds("discord_rest_seconds", "Time until Discord confirmed a REST call", "call=\"message_edit\"");
+Histogram message_delete_seconds("discord_rest_seconds", "Time until Discord confirmed a REST call", "call=\"message_delete\"");
+Counter message_create_errors("discord_rest_errors_total", "Discord REST calls that failed", "call=\"message_create\"");
+Counter message_edit_errors("discord_rest_errors_total", "Discord REST calls that failed", "call=\"message_edit\"");
+Counter message_delete_errors("discord_rest_errors_total", "Discord REST calls that failed", "call=\"message_delete\"");
+
+// Edits and deletions of auto-translated messages
+Counter synced_edits("auto_translate_sync_total", "Edits and deletions applied to auto-translate replies", "event=\"edit\"");
+Counter synced_deletes("auto_translate_sync_total", "Edits and deletions applied to auto-translate replies", "event=\"delete\"");
+Counter unchanged_edits("auto_translate_sync_total", "Edits and deletions applied to auto-translate replies", "event=\"unchanged\"");
+
+// Posts auto-translate replies for the reply dispatcher
+class DiscordReplySink : public ReplySink {
+public:
+    explicit DiscordReplySink(dpp::cluster& bot) : bot_(bot) {}
+
+    void create(uint64_t channel_id, const ReplyPage& page, std::function<void(uint64_t reply_id)> done) override {
+        auto sent = std::chrono::steady_clock::now();
+        bot_.message_create(build(channel_id, page), [sent, done](const dpp::confirmation_callback_t& callback) {
+            message_create_seconds.observe(std::chrono::steady_clock::now() - sent);
+            if (callback.is_error()) {
+                message_create_errors.add();
+                done(0);
+                return;
+            }
+            done(callback.get<dpp::message>().id);
         });
-        if (total_chars > 0 && (float)chinese_count / total_chars > 0.3f) {
-            return "zh-CN";
-        }
     }
 
-    // Use Google Translate API for detection
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        return "en";
+    void edit(uint64_t channel_id, uint64_t reply_id, const ReplyPage& page, std::function<void(bool ok)> done) override {
+        dpp::message edited = build(channel_id, page);
+        edited.id = reply_id;
+        auto sent = std::chrono::steady_clock::now();
+        bot_.message_edit(edited, [sent, done](const dpp::confirmation_callback_t& callback) {
+            message_edit_seconds.observe(std::chrono::steady_clock::now() - sent);
+            if (callback.is_error()) {
+                message_edit_errors.add();
+            }
+            done(!callback.is_error());
+        });
     }
 
-    std::string response;
-    std::string url = "https://translate.googleapis.com/translate_a/single?client=gtx&sl=auto&tl=en&dt=t&q=" + url_encode(cleaned);
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) {
-        return "en";
+    void remove(uint64_t channel_id, uint64_t reply_id) override {
+        auto sent = std::chrono::steady_clock::now();
+        bot_.message_delete(reply_id, channel_id, [sent](const dpp::confirmation_callback_t& callback) {
+            message_delete_seconds.observe(std::chrono::steady_clock::now() - sent);
+            if (callback.is_error()) {
+                message_delete_errors.add();
+            }
+        });
     }
 
-    try {
-        auto j = json::parse(response);
-        if (j.is_array() && j.size() > 2 && j[2].is_string()) {
-            return j[2].get<std::string>();
+private:
+    // One blue embed per page embed, the footer on the last
+    static dpp::message build(uint64_t channel_id, const ReplyPage& page) {
+        dpp::message message(channel_id, "");
+        for (size_t i = 0; i < page.embeds.size(); ++i) {
+            dpp::embed embed = dpp::embed()
+                .set_description(page.embeds[i])
+                .set_color(dpp::colors::blue);
+            if (i + 1 == page.embeds.size()) {
+                embed.set_footer("🌐 Auto-translate", "");
+            }
+            message.add_embed(embed);
+        }
+        if (page.reply_to) {
+            message.set_reference(page.reply_to);
         }
-    } catch (...) {
-        // Default to English on error
+        return message;
     }
 
-    return "en";
+    dpp::cluster& bot_;
+};
+
+// Hash of the command set last registered with Discord, or "" if none is recorded
+static std::string read_command_hash(const std::string& path) {
+    std::ifstream in(path);
+    std::string hash;
+    std::getline(in, hash);
+    return hash;
 }
 
-// Translate text using Google Translate API
-std::string translate_text(const std::string& text, const std::string& source_lang, const std::string& target_lang) {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        return "";
+static void write_command_hash(const std::string& path, const std::string& hash) {
+    std::ofstream out(path, std::ios::trunc);
+    out << hash << "\n";
+    if (!out.good()) {
+        std::cerr << "Error writing " << path << std::endl;
     }
+}
 
-    std::string response;
-    std::string url = "https://translate.googleapis.com/translate_a/single?client=gtx&sl=" +
-                      source_lang + "&tl=" + target_lang + "&dt=t&q=" + url_encode(text);
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "Mozilla/5.0");
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
+int main() {
+    // Load environment variables
+    load_config(".env");
+    std::string token = config_string("DISCORD_BOT_TOKEN");
 
-    if (res != CURLE_OK) {
-        return "";
+    if (token.empty()) {
+        std::cerr << "ERROR: DISCORD_BOT_TOKEN not found in .env file!" << std::endl;
+        return 1;
     }
 
-    try {
-        auto j = json::parse(response);
-        if (j.is_array() && !j.empty() && j[0].is_array()) {
-            std::string result;
-            for (const auto& segment : j[0]) {
-                if (segment.is_array() && !segment.empty() && segment[0].is_string()) {
-                    result += segment[0].get<std::string>();
-                }
-            }
-            return result;
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Translation parse error: " << e.what() << std::endl;
+    // Shards: SHARD_COUNT in all (0 asks Discord), of which this process runs
+    // the ones with shard_id % CLUSTER_COUNT == CLUSTER_ID
+    long cluster_id_setting = config_int("CLUSTER_ID", 0);
+    long cluster_count_setting = config_int("CLUSTER_COUNT", 1);
+    if (cluster_count_setting < 1 || cluster_count_setting > UINT32_MAX) {
+        std::cerr << "ERROR: CLUSTER_COUNT must be at least 1, got " << cluster_count_setting << std::endl;
+        return 1;
     }
-
-    return "";
-}
-
-// Load settings
-void load_settings() {
-    std::lock_guard<std::mutex> lock(settings_mutex);
-
-    std::ifstream file(SETTINGS_FILE);
-    if (!file.is_open()) {
-        return;
+    if (cluster_id_setting < 0 || cluster_id_setting >= cluster_count_setting) {
+        std::cerr << "ERROR: CLUSTER_ID must be between 0 and " << cluster_count_setting - 1
+                  << ", got " << cluster_id_setting << std::endl;
+        return 1;
     }
+    uint32_t cluster_id = cluster_id_setting;
+    uint32_t cluster_count = cluster_count_setting;
 
-    try {
-        json data;
-        file >> data;
-
-        if (data.contains("auto_translate_channels")) {
-            for (auto& [key, value] : data["auto_translate_channels"].items()) {
-                dpp::snowflake channel_id = std::stoull(key);
-                std::vector<std::string> langs;
-
-                if (value.is_string()) {
-                    langs.push_back(value.get<std::string>());
-                } else if (value.is_array()) {
-                    for (const auto& lang : value) {
-                        langs.push_back(lang.get<std::string>());
-                    }
-                }
-
-                auto_translate_channels[channel_id] = langs;
-            }
-        }
-
-        if (data.contains("auto_translate_servers")) {
-            for (auto& [key, value] : data["auto_translate_servers"].items()) {
-                dpp::snowflake server_id = std::stoull(key);
-                std::vector<std::string> langs;
-
-                if (value.is_string()) {
-                    langs.push_back(value.get<std::string>());
-                } else if (value.is_array()) {
-                    for (const auto& lang : value) {
-                        langs.push_back(lang.get<std::string>());
-                    }
-                }
+    // Initialize curl
+    curl_global_init(CURL_GLOBAL_DEFAULT);
 
-                auto_translate_servers[server_id] = langs;
-            }
+    // Connect to the translation service while everything else starts, so
+    // the first translation doesn't pay for DNS, TCP and TLS
+    translation_backend().warm_up([](bool connected) {
+        if (connected) {
+            mark_startup("backend_connected");
+        } else {
+            std::cerr << "Could not reach the translation service ahead of time" << std::endl;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error loading settings: " << e.what() << std::endl;
-    }
-}
-
-// Save settings
-void save_settings() {
-    std::lock_guard<std::mutex> lock(settings_mutex);
-
-    json data;
-    data["auto_translate_channels"] = json::object();
-    data["auto_translate_servers"] = json::object();
+    });
 
-    for (const auto& [channel_id, langs] : auto_translate_channels) {
-        data["auto_translate_channels"][std::to_string(channel_id)] = langs;
-    }
+    // In cluster mode the coordinator daemon owns the settings and hands out
+    // its cache, so this process keeps neither on disk
+    std::string coordinator_socket = config_string("COORDINATOR_SOCKET");
+    bool clustered = !coordinator_socket.empty();
 
-    for (const auto& [server_id, langs] : auto_translate_servers) {
-        data["auto_translate_servers"][std::to_string(server_id)] = langs;
+    // Load settings
+    SettingsStore settings_store(clustered ? "" : config_string("SETTINGS_FILE", "bot_settings.json"));
+    if (!clustered && settings_store.load()) {
+        std::cout << "Auto-translate enabled in " << Settings::count(settings_store.snapshot()->channels) << " channels" << std::endl;
     }
 
-    std::ofstream file(SETTINGS_FILE);
-    if (file.is_open()) {
-        file << data.dump(2);
-    }
-}
+    std::string cache_file = clustered ? "" : config_string("CACHE_SNAPSHOT_FILE");
 
-int main() {
-    // Load environment variables
-    std::string token;
-    std::ifstream env_file(".env");
-    if (env_file.is_open()) {
-        std::string line;
-        while (std::getline(env_file, line)) {
-            if (line.find("DISCORD_BOT_TOKEN=") == 0) {
-                token = line.substr(18);
-                break;
-            }
+    std::unique_ptr<SocketCoordinator> coordinator;
+    if (clustered) {
+        coordinator = std::make_unique<SocketCoordinator>(
+            coordinator_socket, std::chrono::milliseconds(config_int("COORDINATOR_RECONNECT_MS", 1000)));
+        coordinator->join(translation_cache(), settings_store);
+        if (coordinator->wait_synced(std::chrono::seconds(5))) {
+            std::cout << "Auto-translate enabled in " << Settings::count(settings_store.snapshot()->channels) << " channels" << std::endl;
+        } else {
+            std::cerr << "Starting without the cluster's settings; they apply once the coordinator is reachable" << std::endl;
         }
     }
+    mark_startup("settings_loaded");
+
+    // Bounded worker pool that prepares translation work; the requests
+    // themselves run on the event loop
+    WorkerPool pool(
+        std::max<long>(config_int("WORKER_THREADS", 4), 1),
+        std::max<long>(config_int("WORKER_QUEUE_CAPACITY", 256), 1),
+        parse_overflow_policy(config_string("WORKER_OVERFLOW_POLICY", "shed_auto_translate")));
+
+    // Build the detector models and warm the translation cache from the last
+    // snapshot during the gateway handshake rather than before it. Messages
+    // arriving earlier just miss the cache.
+    pool.submit(TaskClass::Interactive, [cache_file]() {
+        warm_up_translator();
+        if (!cache_file.empty() && translation_cache().load(cache_file)) {
+            std::cout << "Loaded " << translation_cache().stats().entries << " cached translations" << std::endl;
+        }
+        mark_startup("translator_ready");
+    });
 
-    if (token.empty()) {
-        std::cerr << "ERROR: DISCORD_BOT_TOKEN not found in .env file!" << std::endl;
-        return 1;
-    }
-
-    // Initialize curl
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    // Shares auto-translate capacity fairly between guilds
+    GuildScheduler scheduler(scheduler_options_from_config());
 
-    // Load settings
-    load_settings();
+    // Auto-translate replies by original message, for edits and deletions
+    ReplyIndex replies(
+        std::max<long>(config_int("REPLY_INDEX_CAPACITY", 16384), 1),
+        std::chrono::seconds(std::max<long>(config_int("REPLY_INDEX_TTL_SECONDS", 24 * 60 * 60), 1)));
 
     // Create bot
-    dpp::cluster bot(token, dpp::i_default_intents | dpp::i_message_content);
+    dpp::cluster bot(token, dpp::i_default_intents | dpp::i_message_content,
+                     config_int("SHARD_COUNT", 0), cluster_id, cluster_count);
 
     bot.on_log(dpp::utility::cout_logger());
 
-    bot.on_ready([&bot](const dpp::ready_t& event) {
-        if (dpp::run_once<struct register_bot_commands>()) {
+    // Gathers each channel's auto-translate replies into as few REST calls as fit
+    DiscordReplySink reply_sink(bot);
+    auto dispatcher = std::make_shared<ReplyDispatcher>(reply_sink, replies, dispatcher_options_from_config());
+
+    std::string command_hash_file = config_string("COMMAND_HASH_FILE", "bot_commands.hash");
+
+    bot.on_ready([&bot, cluster_id, command_hash_file](const dpp::ready_t& event) {
+        mark_startup("gateway_ready");
+
+        // Commands are global, so one process registers them for the cluster
+        if (cluster_id == 0 && dpp::run_once<struct register_bot_commands>()) {
             std::cout << bot.me.username << " has connected to Discord!" << std::endl;
             std::cout << "Bot ID: " << bot.me.id << std::endl;
 
@@ -322,7 +231,7 @@ int main() {
             std::vector<dpp::slashcommand> commands = {
                 dpp::slashcommand("translate", "Translate text to a target language", bot.me.id)
                     .add_option(dpp::command_option(dpp::co_string, "text", "The text to translate", true))
-                    .add_option(dpp::command_option(dpp::co_string, "target_language", "Target language", true)),
+                    .add_option(dpp::command_option(dpp::co_string, "target_language", "Target language", true).set_auto_complete(true)),
 
                 dpp::slashcommand("detectlanguage", "Detect the language of text", bot.me.id)
                     .add_option(dpp::command_option(dpp::co_string, "text", "The text to analyze", true)),
@@ -335,79 +244,148 @@ int main() {
                     .set_default_permissions(dpp::p_manage_guild)
             };
 
-            bot.global_bulk_command_create(commands);
-            std::cout << "Slash commands registered!" << std::endl;
+            // Registering is a rate-limited call that makes clients refetch
+            // the commands, so skip it when nothing changed since last time
+            std::string signature = std::to_string(bot.me.id);
+            for (const auto& command : commands) {
+                signature += command.build_json();
+            }
+            std::string hash = std::to_string(text_hash(signature));
+            if (!command_hash_file.empty() && read_command_hash(command_hash_file) == hash) {
+                std::cout << "Slash commands unchanged, not registering them again" << std::endl;
+                return;
+            }
+
+            bot.global_bulk_command_create(commands, [command_hash_file, hash](const dpp::confirmation_callback_t& callback) {
+                if (callback.is_error()) {
+                    std::cerr << "Error registering slash commands: " << callback.get_error().message << std::endl;
+                    return;
+                }
+                if (!command_hash_file.empty()) {
+                    write_command_hash(command_hash_file, hash);
+                }
+                std::cout << "Slash commands registered!" << std::endl;
+            });
+        }
+    });
+
+    // Suggest languages while the target language is typed
+    bot.on_autocomplete([&bot](const dpp::autocomplete_t& event) {
+        for (const auto& option : event.options) {
+            if (!option.focused || !std::holds_alternative<std::string>(option.value)) {
+                continue;
+            }
+            const Language* matches[25];
+            size_t count = complete_language(std::get<std::string>(option.value), matches, 25);
+
+            dpp::interaction_response response(dpp::ir_autocomplete_reply);
+            for (size_t i = 0; i < count; ++i) {
+                std::string label(matches[i]->name);
+                if (matches[i]->native != matches[i]->name) {
+                    label.append(" · ").append(matches[i]->native);
+                }
+                response.add_autocomplete_choice(dpp::command_option_choice(label, std::string(matches[i]->code)));
+            }
+            bot.interaction_response_create(event.command.id, event.command.token, response);
+            return;
         }
     });
 
     // Handle slash commands
-    bot.on_slashcommand([&bot](const dpp::slashcommand_t& event) {
+    bot.on_slashcommand([&bot, &pool, &settings_store](const dpp::slashcommand_t& event) {
         if (event.command.get_command_name() == "translate") {
             event.thinking();
 
             std::string text = std::get<std::string>(event.get_parameter("text"));
             std::string target_lang = std::get<std::string>(event.get_parameter("target_language"));
 
-            std::string target_code = get_language_code(target_lang);
-            if (target_code.empty()) {
+            const Language* target = find_language(target_lang);
+            if (!target) {
                 event.edit_response("Invalid language: `" + target_lang + "`");
                 return;
             }
+            std::string target_code(target->code);
+
+            // Start the translation from the worker pool; the reply is sent
+            // from the event loop once it completes, so no thread waits on it
+            pool.submit(TaskClass::Interactive, [event, text, target_code]() {
+                translate_message_async(text, {target_code}, nullptr, [event, text, target_code](MessageTranslation& result) {
+                    const std::string& source_lang = result.source_lang;
+
+                    std::string translated;
+                    if (!result.translations.empty()) {
+                        translated = result.translations.front().text;
+                    } else if (same_language(source_lang, target_code)) {
+                        // Already in the target language
+                        translated = text;
+                    }
 
-            // Run translation in separate thread to avoid blocking
-            std::thread([&bot, event, text, target_code]() mutable {
-                std::string source_lang = detect_language(text);
-                std::string translated = translate_text(text, source_lang, target_code);
-
-                if (translated.empty()) {
-                    event.edit_response("Translation error occurred");
-                    return;
-                }
-
-                dpp::embed embed = dpp::embed()
-                    .set_title("🌐 Translation")
-                    .set_color(dpp::colors::blue)
-                    .add_field("Original (" + source_lang + ")", text.substr(0, 1024))
-                    .add_field("Translation (" + target_code + ")", translated.substr(0, 1024))
-                    .set_footer("Requested by " + event.command.get_issuing_user().username, "");
+                    if (translated.empty()) {
+                        event.edit_response(upstream_governor().healthy()
+                            ? "Translation error occurred"
+                            : "The translation service is unavailable right now, please try again later");
+                        return;
+                    }
 
-                event.edit_response(dpp::message().add_embed(embed));
-            }).detach();
+                    mark_startup("first_translation");
+                    dpp::embed embed = dpp::embed()
+                        .set_title("🌐 Translation")
+                        .set_color(dpp::colors::blue)
+                        .add_field("Original (" + source_lang + ")", text.substr(0, 1024))
+                        .add_field("Translation (" + target_code + ")", translated.substr(0, 1024))
+                        .set_footer("Requested by " + event.command.get_issuing_user().username, "");
+
+                    event.edit_response(dpp::message().add_embed(embed));
+                });
+            }, [event]() {
+                event.edit_response("The bot is busy right now, please try again in a moment");
+            });
         }
         else if (event.command.get_command_name() == "detectlanguage") {
             std::string text = std::get<std::string>(event.get_parameter("text"));
 
-            std::thread([event, text]() mutable {
-                std::string detected = detect_language(text);
+            pool.submit(TaskClass::Interactive, [event, text]() {
+                detect_language_async(text, [event, text](const std::string& detected) {
+                    const Language* language = language_by_code(detected);
+                    std::string lang_name = language ? std::string(language->name) : detected;
 
-                std::string lang_name = detected;
-                for (const auto& [name, code] : LANGUAGE_NAMES) {
-                    if (code == detected) {
-                        lang_name = name;
-                        break;
-                    }
-                }
-
-                dpp::embed embed = dpp::embed()
-                    .set_title("🔍 Language Detection")
-                    .set_color(dpp::colors::purple)
-                    .add_field("Text", text.substr(0, 1024))
-                    .add_field("Detected Language", lang_name + " (" + detected + ")");
-
-                event.reply(dpp::message().add_embed(embed));
-            }).detach();
+                    dpp::embed embed = dpp::embed()
+                        .set_title("🔍 Language Detection")
+                        .set_color(dpp::colors::purple)
+                        .add_field("Text", text.substr(0, 1024))
+                        .add_field("Detected Language", lang_name + " (" + detected + ")");
+
+                    event.reply(dpp::message().add_embed(embed));
+                });
+            }, [event]() {
+                event.reply("The bot is busy right now, please try again in a moment");
+            });
         }
         else if (event.command.get_command_name() == "languages") {
-            std::string lang_list;
-            for (const auto& [name, code] : LANGUAGE_NAMES) {
-                lang_list += "**" + name + "**: `" + code + "`\n";
-            }
-
             dpp::embed embed = dpp::embed()
                 .set_title("🌍 Supported Languages")
-                .set_description(lang_list)
                 .set_color(dpp::colors::gold)
-                .set_footer("Use language names or codes in commands", "");
+                .set_footer("Use language names, native names or codes in commands", "");
+
+            // Embed fields hold 1024 characters, so the list spans several
+            std::string lang_list;
+            for (size_t i = 0; i < LANGUAGE_COUNT; ++i) {
+                const Language& language = LANGUAGES[i];
+                std::string line;
+                line.append(language.flag).append(" ").append(language.name);
+                if (language.native != language.name) {
+                    line.append(" · ").append(language.native);
+                }
+                line.append(" `").append(language.code).append("`\n");
+                if (lang_list.size() + line.size() > 1024) {
+                    embed.add_field("\u200b", lang_list, true);
+                    lang_list.clear();
+                }
+                lang_list += line;
+            }
+            if (!lang_list.empty()) {
+                embed.add_field("\u200b", lang_list, true);
+            }
 
             event.reply(dpp::message().add_embed(embed));
         }
@@ -423,20 +401,12 @@ int main() {
                 std::string lang;
 
                 while (std::getline(ss, lang, ',')) {
-                    // Trim whitespace
-                    lang.erase(lang.begin(), std::find_if(lang.begin(), lang.end(), [](unsigned char ch) {
-                        return !std::isspace(ch);
-                    }));
-                    lang.erase(std::find_if(lang.rbegin(), lang.rend(), [](unsigned char ch) {
-                        return !std::isspace(ch);
-                    }).base(), lang.end());
-
-                    std::string code = get_language_code(lang);
-                    if (code.empty()) {
+                    const Language* language = find_language(lang);
+                    if (!language) {
                         event.reply("Invalid language: `" + lang + "`");
                         return;
                     }
-                    target_codes.push_back(code);
+                    target_codes.emplace_back(language->code);
                 }
 
                 if (target_codes.empty()) {
@@ -444,8 +414,7 @@ int main() {
                     return;
                 }
 
-                auto_translate_channels[channel_id] = target_codes;
-                save_settings();
+                settings_store.set_channel(channel_id, target_codes);
 
                 std::string lang_display;
                 for (const auto& code : target_codes) {
@@ -457,10 +426,8 @@ int main() {
 
                 event.reply("✅ Auto-translation enabled for this channel\n🌐 Target languages: " + lang_display);
             } else {
-                auto it = auto_translate_channels.find(channel_id);
-                if (it != auto_translate_channels.end()) {
-                    auto_translate_channels.erase(it);
-                    save_settings();
+                if (Settings::find(settings_store.snapshot()->channels, channel_id)) {
+                    settings_store.set_channel(channel_id, {});
                 }
                 event.reply("✅ Auto-translation disabled for this channel");
             }
@@ -468,7 +435,7 @@ int main() {
     });
 
     // Handle messages for auto-translation
-    bot.on_message_create([&bot](const dpp::message_create_t& event) {
+    bot.on_message_create([&pool, &scheduler, &settings_store, dispatcher](const dpp::message_create_t& event) {
         if (event.msg.author.is_bot()) {
             return;
         }
@@ -477,73 +444,244 @@ int main() {
             return;
         }
 
-        // Check for URL/link only messages
-        std::regex url_pattern("^https?://\\S+$", std::regex::icase);
-        if (std::regex_match(event.msg.content, url_pattern)) {
+        // Check if auto-translate is enabled
+        std::shared_ptr<const Settings> settings = settings_store.snapshot();
+        const std::vector<std::string>* targets = settings->targets_for(event.msg.channel_id, event.msg.guild_id);
+        if (!targets || targets->empty()) {
             return;
         }
+        const std::vector<std::string>& target_langs = *targets;
 
-        std::string cleaned = clean_text_for_detection(event.msg.content);
-        if (cleaned.empty()) {
+        // Shed auto-translate work while the translation backend is failing
+        if (!upstream_governor().healthy()) {
             return;
         }
 
-        // Check if auto-translate is enabled
-        std::vector<std::string> target_langs;
-
-        auto channel_it = auto_translate_channels.find(event.msg.channel_id);
-        if (channel_it != auto_translate_channels.end()) {
-            target_langs = channel_it->second;
-        } else if (event.msg.guild_id) {
-            auto server_it = auto_translate_servers.find(event.msg.guild_id);
-            if (server_it != auto_translate_servers.end()) {
-                target_langs = server_it->second;
-            }
+        // Skip link-only and emoji-only messages
+        std::string cleaned;
+        if (!prepare_auto_translate(event.msg.content, cleaned)) {
+            return;
         }
 
-        if (!target_langs.empty()) {
-            // Process auto-translation in a separate thread
-            std::thread([&bot, event, cleaned, target_langs]() {
-                std::string source_lang = detect_language(cleaned);
+        // Wait for this guild's turn, then start auto-translation from the
+        // worker pool; results arrive on the event loop
+        auto cost = static_cast<uint32_t>(target_langs.size());
+        ReplyOrigin origin{event.msg.id, event.msg.channel_id, event.msg.guild_id, text_hash(event.msg.content)};
+        scheduler.submit(event.msg.guild_id, cost, [&pool, dispatcher, origin, cleaned, target_langs](GuildScheduler::Done done) {
+            pool.submit(TaskClass::AutoTranslate, [dispatcher, origin, cleaned, target_langs, done]() {
+                // Each translation goes to the dispatcher as it arrives; those
+                // ready within the channel's window share one REST call
+                auto text = std::make_shared<ReplyText>(target_langs);
+
+                // Sentence by sentence, so a later edit only pays for the sentences it changes
+                translate_sentences_async(cleaned, "", target_langs, [dispatcher, origin, text](const std::string& source_lang, const Translation& translation) {
+                    mark_startup("first_translation");
+                    dispatcher->update(origin, source_lang, text->add(translation));
+                }, [done](MessageTranslation&) { done(); });
+            }, done);
+        });
+    });
 
-                std::string description;
-                bool has_translations = false;
+    // Re-translate edited messages and update their reply in place. Unchanged
+    // sentences come from the cache, so only the edited ones go upstream.
+    bot.on_message_update([&pool, &scheduler, &settings_store, &replies, dispatcher](const dpp::message_update_t& event) {
+        if (event.msg.author.is_bot()) {
+            return;
+        }
 
-                for (const auto& target_lang : target_langs) {
-                    // Skip if same language
-                    std::string source_base = source_lang.substr(0, 2);
-                    std::string target_base = target_lang.substr(0, 2);
+        // Only messages that got a reply recently enough to still be indexed
+        ReplyRecord record;
+        if (!replies.find(event.msg.id, record)) {
+            return;
+        }
 
-                    if (source_lang == target_lang || source_base == target_base) {
-                        continue;
-                    }
+        // Embeds being added to a message also count as an update
+        uint32_t content_hash = text_hash(event.msg.content);
+        if (content_hash == record.content_hash) {
+            return;
+        }
 
-                    std::string translated = translate_text(cleaned, source_lang, target_lang);
-                    if (!translated.empty()) {
-                        std::string flag = LANGUAGE_FLAGS.count(target_lang) ? LANGUAGE_FLAGS[target_lang] : "🌐";
-                        std::string upper_code = target_lang;
-                        std::transform(upper_code.begin(), upper_code.end(), upper_code.begin(), ::toupper);
+        std::shared_ptr<const Settings> settings = settings_store.snapshot();
+        const std::vector<std::string>* targets = settings->targets_for(event.msg.channel_id, event.msg.guild_id);
+        if (!targets || targets->empty() || !upstream_governor().healthy()) {
+            return;
+        }
+        const std::vector<std::string>& target_langs = *targets;
 
-                        description += flag + " **" + upper_code + ":** " + translated.substr(0, 500) + "\n";
-                        has_translations = true;
-                    }
-                }
+        // Edited down to links or emoji: the reply has nothing left to say
+        std::string cleaned;
+        if (!prepare_auto_translate(event.msg.content, cleaned)) {
+            if (dispatcher->remove(event.msg.id, event.msg.channel_id)) {
+                synced_deletes.add();
+            }
+            return;
+        }
 
-                if (has_translations) {
-                    dpp::embed embed = dpp::embed()
-                        .set_description(description)
-                        .set_color(dpp::colors::blue)
-                        .set_footer("🌐 Auto-translate", "");
+        // A translation still running for an earlier edit must not land after this one
+        record.content_hash = content_hash;
+        ++record.revision;
+        replies.put(record);
+
+        ReplyOrigin origin{event.msg.id, event.msg.channel_id, event.msg.guild_id, content_hash};
+        uint32_t revision = record.revision;
+        std::string source_lang(record.source());
+
+        auto cost = static_cast<uint32_t>(target_langs.size());
+        scheduler.submit(event.msg.guild_id, cost, [&pool, &replies, dispatcher, origin, revision, source_lang, cleaned, target_langs](GuildScheduler::Done done) {
+            pool.submit(TaskClass::AutoTranslate, [&replies, dispatcher, origin, revision, source_lang, cleaned, target_langs, done]() {
+                translate_sentences_async(cleaned, source_lang, target_langs, nullptr,
+                    [&replies, dispatcher, origin, revision, target_langs, done](MessageTranslation& result) {
+                        done();
+                        if (result.translations.empty()) {
+                            return;
+                        }
+
+                        ReplyRecord current;
+                        if (!replies.find(origin.id, current) || current.revision != revision) {
+                            return;
+                        }
+
+                        ReplyText text(target_langs);
+                        for (const auto& translation : result.translations) {
+                            text.add(translation);
+                        }
+
+                        // No edit if the translations came out the same
+                        if (text_hash(text.description()) == current.reply_hash) {
+                            unchanged_edits.add();
+                            return;
+                        }
+
+                        synced_edits.add();
+                        dispatcher->update(origin, result.source_lang, text.description());
+                    });
+            }, done);
+        });
+    });
 
-                    bot.message_create(dpp::message(event.msg.channel_id, "").add_embed(embed).set_reference(event.msg.id));
-                }
-            }).detach();
+    // Take down the reply of a deleted message
+    bot.on_message_delete([dispatcher](const dpp::message_delete_t& event) {
+        if (dispatcher->remove(event.id, event.channel_id)) {
+            synced_deletes.add();
         }
     });
 
+    // Report worker pool load once a minute
+    bot.start_timer([&bot, &pool, &scheduler, &replies, dispatcher, &coordinator](dpp::timer) {
+        WorkerPoolStats stats = pool.stats();
+        if (stats.submitted == 0) {
+            return;
+        }
+        bot.log(dpp::ll_info, "Worker pool: queue=" + std::to_string(stats.queue_depth) +
+                " peak=" + std::to_string(stats.max_queue_depth) +
+                " completed=" + std::to_string(stats.completed) +
+                " dropped=" + std::to_string(stats.dropped) +
+                " avg_wait=" + std::to_string(stats.avg_wait_ms) + "ms" +
+                " max_wait=" + std::to_string(stats.max_wait_ms) + "ms");
+
+        SchedulerStats scheduled = scheduler.stats();
+        bot.log(dpp::ll_info, "Guild scheduler: queued=" + std::to_string(scheduled.queued) +
+                " in_flight=" + std::to_string(scheduled.in_flight) +
+                " active_guilds=" + std::to_string(scheduled.active_guilds) +
+                " dispatched=" + std::to_string(scheduled.dispatched) +
+                " over_quota=" + std::to_string(scheduled.dropped_quota) +
+                " queue_full=" + std::to_string(scheduled.dropped_queue_full));
+
+        CacheStats cache = translation_cache().stats();
+        bot.log(dpp::ll_info, "Translation cache: entries=" + std::to_string(cache.entries) +
+                " bytes=" + std::to_string(cache.bytes) +
+                " hits=" + std::to_string(cache.hits) +
+                " misses=" + std::to_string(cache.misses) +
+                " evictions=" + std::to_string(cache.evictions) +
+                " expired=" + std::to_string(cache.expirations));
+
+        ReplyIndexStats indexed = replies.stats();
+        bot.log(dpp::ll_info, "Reply index: entries=" + std::to_string(indexed.entries) +
+                " capacity=" + std::to_string(indexed.capacity) +
+                " evictions=" + std::to_string(indexed.evictions) +
+                " expired=" + std::to_string(indexed.expirations));
+
+        DispatcherStats dispatched = dispatcher->stats();
+        bot.log(dpp::ll_info, "Reply dispatcher: channels=" + std::to_string(dispatched.channels) +
+                " pending=" + std::to_string(dispatched.pending) +
+                " created=" + std::to_string(dispatched.created) +
+                " sections=" + std::to_string(dispatched.sections) +
+                " edits=" + std::to_string(dispatched.edits) +
+                " failed_edits=" + std::to_string(dispatched.failed_edits) +
+                " deletes=" + std::to_string(dispatched.deletes) +
+                " deferred=" + std::to_string(dispatched.deferred) +
+                " unavailable=" + std::to_string(dispatched.unavailable));
+
+        if (coordinator) {
+            CoordinatorStats cluster = coordinator->stats();
+            bot.log(dpp::ll_info, "Coordinator: connected=" + std::string(cluster.connected ? "yes" : "no") +
+                    " connects=" + std::to_string(cluster.connects) +
+                    " sent=" + std::to_string(cluster.frames_sent) +
+                    " received=" + std::to_string(cluster.frames_received) +
+                    " dropped=" + std::to_string(cluster.dropped_puts));
+        }
+
+        bot.log(dpp::ll_info, "Single-flight: saved=" + std::to_string(single_flight_saved()) + " upstream calls");
+
+        bot.log(dpp::ll_info, "In flight: translations=" + std::to_string(translations_in_flight()) +
+                " requests=" + std::to_string(event_loop().transfers_in_flight()));
+
+        GovernorStats upstream = upstream_governor().stats();
+        bot.log(dpp::ll_info, "Upstream: circuit=" + std::string(upstream.circuit) +
+                " rate=" + std::to_string(upstream.rate) + "/s" +
+                " admitted=" + std::to_string(upstream.admitted) +
+                " rejected=" + std::to_string(upstream.rejected) +
+                " retries=" + std::to_string(upstream.retries) +
+                " rate_limited=" + std::to_string(upstream.rate_limited));
+
+        BatchStats batch = translation_batch_stats();
+        if (batch.batches > 0) {
+            bot.log(dpp::ll_info, "Batching: batches=" + std::to_string(batch.batches) +
+                    " items=" + std::to_string(batch.items) +
+                    " fill=" + std::to_string(batch.fill_ratio) +
+                    " split_failures=" + std::to_string(batch.split_failures));
+        }
+    }, 60);
+
+    // Periodically snapshot the cache so a restart starts warm
+    if (!cache_file.empty()) {
+        bot.start_timer([cache_file](dpp::timer) {
+            translation_cache().save(cache_file);
+        }, config_int("CACHE_SNAPSHOT_INTERVAL_SECONDS", 300));
+    }
+
+    // Fold the settings change log into the settings file
+    bot.start_timer([&settings_store](dpp::timer) {
+        settings_store.compact();
+    }, config_int("SETTINGS_COMPACT_INTERVAL_SECONDS", 300));
+
+    // Prometheus endpoint and periodic dump
+    MetricsServer metrics_server;
+    int metrics_port = config_int("METRICS_PORT", 0);
+    if (metrics_port > 0 && metrics_server.start(config_string("METRICS_ADDRESS", "127.0.0.1"), metrics_port)) {
+        std::cout << "Serving metrics on port " << metrics_port << std::endl;
+    }
+
+    std::string metrics_file = config_string("METRICS_FILE");
+    if (!metrics_file.empty()) {
+        bot.start_timer([metrics_file](dpp::timer) {
+            dump_metrics(metrics_file);
+        }, config_int("METRICS_DUMP_INTERVAL_SECONDS", 60));
+    }
+
     // Start the bot
     bot.start(dpp::st_wait);
 
+    pool.shutdown();
+    settings_store.compact();
+
+    if (!cache_file.empty()) {
+        translation_cache().save(cache_file);
+    }
+    if (!metrics_file.empty()) {
+        dump_metrics(metrics_file);
+    }
+
     curl_global_cleanup();
     return 0;
 }
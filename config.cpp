@@ -0,0 +1,89 @@
+#include "config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+static std::map<std::string, std::string> config_values;
+
+static std::string trim(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t\r\n");
+    return value.substr(start, end - start + 1);
+}
+
+bool load_config(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+
+        config_values[trim(line.substr(0, eq))] = trim(line.substr(eq + 1));
+    }
+
+    return true;
+}
+
+std::string config_string(const std::string& key, const std::string& fallback) {
+    if (const char* env = std::getenv(key.c_str())) {
+        return env;
+    }
+
+    auto it = config_values.find(key);
+    return it != config_values.end() ? it->second : fallback;
+}
+
+long config_int(const std::string& key, long fallback) {
+    std::string value = config_string(key);
+    if (value.empty()) {
+        return fallback;
+    }
+
+    try {
+        return std::stol(value);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+double config_double(const std::string& key, double fallback) {
+    std::string value = config_string(key);
+    if (value.empty()) {
+        return fallback;
+    }
+
+    try {
+        return std::stod(value);
+    } catch (...) {
+        return fallback;
+    }
+}
+
+bool config_bool(const std::string& key, bool fallback) {
+    std::string value = config_string(key);
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+    if (value == "1" || value == "true" || value == "yes" || value == "on") {
+        return true;
+    }
+    if (value == "0" || value == "false" || value == "no" || value == "off") {
+        return false;
+    }
+    return fallback;
+}
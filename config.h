@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+// Load KEY=VALUE pairs from an env file. Variables set in the process
+// environment take precedence over the file.
+bool load_config(const std::string& path);
+
+std::string config_string(const std::string& key, const std::string& fallback = "");
+long config_int(const std::string& key, long fallback);
+double config_double(const std::string& key, double fallback);
+bool config_bool(const std::string& key, bool fallback);
@@ -0,0 +1,750 @@
+#include "coordinator.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+
+#include "metrics.h"
+
+// Frames are a 4-byte body length followed by the body, whose first byte is
+// the frame type. Both ends run on the same host, so integers are sent in
+// native byte order and strings as a 4-byte length and the bytes.
+//   'P' cache entry:        key, value, i64 expires_at
+//   'S' settings change:    u8 scope, u64 id, u32 count, langs, i64 sent_at_ms
+//   'R' all settings:       u32 count, then scope, id and langs per entry
+static const char FRAME_PUT = 'P';
+static const char FRAME_SETTINGS = 'S';
+static const char FRAME_RESET = 'R';
+
+static const uint32_t MAX_FRAME_BYTES = 64 << 20;
+
+// Queued bytes past which cache entries are dropped rather than sent to a
+// slow peer; a process that falls this far behind is caught up on reconnect
+static const size_t MAX_BACKLOG_BYTES = 256 << 20;
+
+static Counter frames_sent("cluster_frames_total", "Frames exchanged with the coordinator", "direction=\"sent\"");
+static Counter frames_received("cluster_frames_total", "Frames exchanged with the coordinator", "direction=\"received\"");
+static Counter frames_dropped("cluster_dropped_puts_total", "Cache entries not shared because the coordinator was unreachable or behind");
+static Counter connects("cluster_connects_total", "Connections made to the coordinator");
+static Histogram settings_propagation("cluster_settings_propagation_seconds",
+                                      "Time from a settings change being made to it being applied here");
+
+namespace {
+
+class FrameWriter {
+public:
+    explicit FrameWriter(char type) : frame_(sizeof(uint32_t), '\0') { frame_ += type; }
+
+    template <typename T>
+    FrameWriter& pod(T value) {
+        frame_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        return *this;
+    }
+
+    FrameWriter& str(const std::string& value) {
+        pod(static_cast<uint32_t>(value.size()));
+        frame_ += value;
+        return *this;
+    }
+
+    FrameWriter& change(const SettingsChange& change) {
+        pod(static_cast<uint8_t>(change.scope == SettingsScope::Server));
+        pod(change.id);
+        pod(static_cast<uint32_t>(change.langs.size()));
+        for (const auto& lang : change.langs) {
+            str(lang);
+        }
+        return *this;
+    }
+
+    // The frame, length prefix included
+    std::string finish() {
+        uint32_t length = static_cast<uint32_t>(frame_.size() - sizeof(uint32_t));
+        std::memcpy(&frame_[0], &length, sizeof(length));
+        return std::move(frame_);
+    }
+
+private:
+    std::string frame_;
+};
+
+// Reads a frame body; every read fails once one has run past the end
+class FrameReader {
+public:
+    explicit FrameReader(const std::string& body) : body_(body) {}
+
+    template <typename T>
+    bool pod(T& value) {
+        if (body_.size() - pos_ < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, body_.data() + pos_, sizeof(value));
+        pos_ += sizeof(value);
+        return true;
+    }
+
+    bool str(std::string& value) {
+        uint32_t length = 0;
+        if (!pod(length) || body_.size() - pos_ < length) {
+            return false;
+        }
+        value.assign(body_, pos_, length);
+        pos_ += length;
+        return true;
+    }
+
+    bool change(SettingsChange& change) {
+        uint8_t server = 0;
+        uint32_t count = 0;
+        if (!pod(server) || !pod(change.id) || !pod(count)) {
+            return false;
+        }
+        change.scope = server ? SettingsScope::Server : SettingsScope::Channel;
+        change.langs.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string lang;
+            if (!str(lang)) {
+                return false;
+            }
+            change.langs.push_back(std::move(lang));
+        }
+        return true;
+    }
+
+private:
+    const std::string& body_;
+    size_t pos_ = 1;  // Past the type
+};
+
+int64_t unix_millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string put_frame(const std::string& key, const std::string& value, int64_t expires_at) {
+    return FrameWriter(FRAME_PUT).str(key).str(value).pod(expires_at).finish();
+}
+
+std::string settings_frame(const SettingsChange& change) {
+    return FrameWriter(FRAME_SETTINGS).change(change).pod(unix_millis()).finish();
+}
+
+std::string reset_frame(const std::vector<SettingsChange>& entries) {
+    FrameWriter writer(FRAME_RESET);
+    writer.pod(static_cast<uint32_t>(entries.size()));
+    for (const auto& entry : entries) {
+        writer.change(entry);
+    }
+    return writer.finish();
+}
+
+// Hand every complete frame body at the front of buffer to handle and drop
+// it. False if the buffer holds something that can't be a frame.
+template <typename Handle>
+bool drain_frames(std::string& buffer, Handle handle) {
+    size_t pos = 0;
+    while (buffer.size() - pos >= sizeof(uint32_t)) {
+        uint32_t length = 0;
+        std::memcpy(&length, buffer.data() + pos, sizeof(length));
+        if (length == 0 || length > MAX_FRAME_BYTES) {
+            return false;
+        }
+        if (buffer.size() - pos - sizeof(uint32_t) < length) {
+            break;
+        }
+        handle(buffer.substr(pos + sizeof(uint32_t), length));
+        pos += sizeof(uint32_t) + length;
+    }
+    buffer.erase(0, pos);
+    return true;
+}
+
+// Read what the socket has and handle the frames completed by it. False once
+// the peer has closed the connection or sent garbage.
+template <typename Handle>
+bool read_frames(int fd, std::string& buffer, Handle handle) {
+    char chunk[65536];
+    ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    if (n == 0) {
+        return false;
+    }
+    buffer.append(chunk, n);
+    return drain_frames(buffer, handle);
+}
+
+// Send as much of out past written as the socket takes. False on error.
+bool write_frames(int fd, std::string& out, size_t& written) {
+    ssize_t n = send(fd, out.data() + written, out.size() - written, MSG_NOSIGNAL);
+    if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+    written += n;
+    if (written == out.size()) {
+        out.clear();
+        written = 0;
+    } else if (written > out.size() / 2) {
+        // Drop the frames sent in full, so out still starts on a frame
+        size_t boundary = 0;
+        while (true) {
+            uint32_t length = 0;
+            std::memcpy(&length, out.data() + boundary, sizeof(length));
+            if (boundary + sizeof(uint32_t) + length > written) {
+                break;
+            }
+            boundary += sizeof(uint32_t) + length;
+        }
+        out.erase(0, boundary);
+        written -= boundary;
+    }
+    return true;
+}
+
+bool socket_address(const std::string& path, sockaddr_un& addr) {
+    addr = sockaddr_un{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Invalid coordinator socket path: " << path << std::endl;
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+int connect_unix(const std::string& path) {
+    sockaddr_un addr;
+    if (!socket_address(path, addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// The settings frames of out that were not sent in full before the connection
+// broke. The daemon only acts on whole frames, so one cut off halfway never
+// reached it and is resent too
+std::string unsent_settings(const std::string& out, size_t written) {
+    std::string kept;
+    size_t pos = 0;
+    while (out.size() - pos > sizeof(uint32_t)) {
+        uint32_t length = 0;
+        std::memcpy(&length, out.data() + pos, sizeof(length));
+        size_t end = pos + sizeof(uint32_t) + length;
+        if (end > written && out[pos + sizeof(uint32_t)] == FRAME_SETTINGS) {
+            kept.append(out, pos, end - pos);
+        }
+        pos = end;
+    }
+    return kept;
+}
+
+}  // namespace
+
+// What the I/O thread shares with the listeners set on the cache and the
+// settings store, which can be called after the coordinator is gone
+struct SocketCoordinator::State {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::string outbox;  // Frames for the I/O thread to send
+    size_t in_flight = 0;  // Bytes the I/O thread has taken but not sent yet
+    bool connected = false;
+    bool synced = false;
+    bool stopping = false;
+    CoordinatorStats stats;
+    int wake_fds[2] = {-1, -1};
+
+    State() {
+        if (pipe2(wake_fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+            std::cerr << "Cannot create the coordinator wake-up pipe" << std::endl;
+        }
+    }
+
+    ~State() {
+        for (int fd : wake_fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    void wake() {
+        char byte = 0;
+        if (write(wake_fds[1], &byte, 1) < 0) {
+            // Already awake
+        }
+    }
+
+    // Settings changes wait for a connection; cache entries are shared now or never
+    void queue(std::string frame, bool settings) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        if (!settings && (!connected || outbox.size() + in_flight > MAX_BACKLOG_BYTES)) {
+            ++stats.dropped_puts;
+            frames_dropped.add();
+            return;
+        }
+        bool idle = outbox.empty();
+        outbox += frame;
+        ++stats.frames_sent;
+        frames_sent.add();
+        if (idle) {
+            wake();
+        }
+    }
+};
+
+SocketCoordinator::SocketCoordinator(std::string socket_path, std::chrono::milliseconds reconnect_delay)
+    : socket_path_(std::move(socket_path)), reconnect_delay_(reconnect_delay), state_(std::make_shared<State>()) {}
+
+SocketCoordinator::~SocketCoordinator() {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stopping = true;
+        state_->wake();
+    }
+    state_->changed.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SocketCoordinator::join(TranslationCache& cache, SettingsStore& settings) {
+    cache_ = &cache;
+    settings_ = &settings;
+
+    std::shared_ptr<State> state = state_;
+    cache.set_listener([state](const std::string& key, const std::string& value, int64_t expires_at) {
+        state->queue(put_frame(key, value, expires_at), false);
+    });
+    settings.set_listener([state](const SettingsChange& change) { state->queue(settings_frame(change), true); });
+
+    thread_ = std::thread(&SocketCoordinator::run, this);
+}
+
+bool SocketCoordinator::wait_synced(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    return state_->changed.wait_for(lock, timeout, [this] { return state_->synced; });
+}
+
+CoordinatorStats SocketCoordinator::stats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->stats;
+}
+
+void SocketCoordinator::run() {
+    State& state = *state_;
+    std::string in;
+    std::string out;  // Settings changes left over from a broken connection, then what is being sent
+    bool reported = false;
+
+    while (true) {
+        int fd = connect_unix(socket_path_);
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            if (fd < 0) {
+                state.changed.wait_for(lock, reconnect_delay_, [&state] { return state.stopping; });
+            }
+            if (state.stopping) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+                return;
+            }
+            if (fd < 0) {
+                if (!reported) {
+                    std::cerr << "Cannot reach the coordinator at " << socket_path_ << ", retrying" << std::endl;
+                    reported = true;
+                }
+                continue;
+            }
+            state.connected = true;
+            state.stats.connected = true;
+            ++state.stats.connects;
+        }
+        connects.add();
+        std::cout << "Connected to the coordinator at " << socket_path_ << std::endl;
+        reported = false;
+
+        in.clear();
+        size_t written = 0;
+        bool open = true;
+        while (open) {
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (state.stopping) {
+                    break;
+                }
+                if (!state.outbox.empty()) {
+                    out += state.outbox;
+                    state.outbox.clear();
+                }
+                state.in_flight = out.size() - written;
+            }
+
+            // Wake up regularly to notice the destructor
+            short events = written < out.size() ? POLLIN | POLLOUT : POLLIN;
+            pollfd fds[2] = {{fd, events, 0}, {state.wake_fds[0], POLLIN, 0}};
+            if (poll(fds, 2, 500) < 0) {
+                open = errno == EINTR;
+                continue;
+            }
+
+            if (fds[1].revents & POLLIN) {
+                char drain[64];
+                while (read(state.wake_fds[0], drain, sizeof(drain)) > 0) {
+                }
+            }
+            if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+                open = read_frames(fd, in, [this](const std::string& frame) { handle_frame(frame); });
+            }
+            if (open && (fds[0].revents & POLLOUT)) {
+                open = write_frames(fd, out, written);
+            }
+        }
+        close(fd);
+        out = unsent_settings(out, written);
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.connected = false;
+        state.synced = false;
+        state.in_flight = 0;
+        state.stats.connected = false;
+        if (state.stopping) {
+            return;
+        }
+        std::cerr << "Lost the connection to the coordinator at " << socket_path_ << std::endl;
+    }
+}
+
+void SocketCoordinator::handle_frame(const std::string& frame) {
+    frames_received.add();
+    FrameReader reader(frame);
+
+    if (frame[0] == FRAME_PUT) {
+        std::string key;
+        std::string value;
+        int64_t expires_at = 0;
+        if (reader.str(key) && reader.str(value) && reader.pod(expires_at)) {
+            cache_->put_shared(key, std::move(value), expires_at);
+        }
+    } else if (frame[0] == FRAME_SETTINGS) {
+        SettingsChange change;
+        int64_t sent_at_ms = 0;
+        if (reader.change(change) && reader.pod(sent_at_ms)) {
+            settings_->apply_shared(change);
+            settings_propagation.observe(std::max<int64_t>(unix_millis() - sent_at_ms, 0) / 1000.0);
+        }
+    } else if (frame[0] == FRAME_RESET) {
+        uint32_t count = 0;
+        std::vector<SettingsChange> entries;
+        bool ok = reader.pod(count);
+        for (uint32_t i = 0; ok && i < count; ++i) {
+            SettingsChange entry;
+            ok = reader.change(entry);
+            entries.push_back(std::move(entry));
+        }
+        if (ok) {
+            settings_->replace(entries);
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->synced = true;
+            state_->changed.notify_all();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    ++state_->stats.frames_received;
+}
+
+// Relays on a thread of its own: the listeners are called under the
+// settings store's write lock, so applying changes to other stores there
+// could deadlock two processes changing settings at once
+struct LocalCoordinator::Hub {
+    struct Node {
+        TranslationCache* cache;
+        SettingsStore* settings;
+    };
+
+    struct Event {
+        size_t origin;
+        bool is_settings;
+        SettingsChange change;
+        std::string key;
+        std::string value;
+        int64_t expires_at;
+    };
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Node> nodes;
+    std::deque<Event> events;
+    bool busy = false;
+    bool stopping = false;
+
+    // What the daemon keeps for processes that join later
+    SettingsStore settings{""};
+    TranslationCache cache{size_t(64) << 20, std::chrono::hours(24)};
+
+    void push(Event event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!stopping) {
+            events.push_back(std::move(event));
+            changed.notify_all();
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return stopping || !events.empty(); });
+            if (events.empty()) {
+                return;
+            }
+            Event event = std::move(events.front());
+            events.pop_front();
+            std::vector<Node> targets = nodes;
+            busy = true;
+            lock.unlock();
+
+            if (event.is_settings) {
+                settings.apply_shared(event.change);
+                for (const auto& node : targets) {
+                    node.settings->apply_shared(event.change);
+                }
+            } else {
+                cache.put_shared(event.key, event.value, event.expires_at);
+                for (size_t i = 0; i < targets.size(); ++i) {
+                    if (i != event.origin) {
+                        targets[i].cache->put_shared(event.key, event.value, event.expires_at);
+                    }
+                }
+            }
+
+            lock.lock();
+            busy = false;
+            changed.notify_all();
+        }
+    }
+};
+
+LocalCoordinator::LocalCoordinator() : hub_(std::make_shared<Hub>()) {
+    thread_ = std::thread([hub = hub_.get()] { hub->run(); });
+}
+
+LocalCoordinator::~LocalCoordinator() {
+    {
+        std::lock_guard<std::mutex> lock(hub_->mutex);
+        hub_->stopping = true;
+    }
+    hub_->changed.notify_all();
+    thread_.join();
+}
+
+void LocalCoordinator::join(TranslationCache& cache, SettingsStore& settings) {
+    flush();
+    size_t origin;
+    {
+        std::lock_guard<std::mutex> lock(hub_->mutex);
+        origin = hub_->nodes.size();
+        hub_->nodes.push_back({&cache, &settings});
+    }
+
+    settings.replace(hub_->settings.entries());
+    hub_->cache.for_each([&cache](const std::string& key, const std::string& value, int64_t expires_at) {
+        cache.put_shared(key, value, expires_at);
+    });
+
+    std::shared_ptr<Hub> hub = hub_;
+    cache.set_listener([hub, origin](const std::string& key, const std::string& value, int64_t expires_at) {
+        hub->push({origin, false, {}, key, value, expires_at});
+    });
+    settings.set_listener([hub, origin](const SettingsChange& change) {
+        hub->push({origin, true, change, "", "", 0});
+    });
+}
+
+void LocalCoordinator::flush() {
+    std::unique_lock<std::mutex> lock(hub_->mutex);
+    hub_->changed.wait(lock, [this] { return hub_->events.empty() && !hub_->busy; });
+}
+
+CoordinatorServer::CoordinatorServer(std::string socket_path, TranslationCache& cache, SettingsStore& settings)
+    : socket_path_(std::move(socket_path)), cache_(cache), settings_(settings) {}
+
+CoordinatorServer::~CoordinatorServer() {
+    for (const auto& client : clients_) {
+        close(client->fd);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(socket_path_.c_str());
+    }
+}
+
+bool CoordinatorServer::start() {
+    sockaddr_un addr;
+    if (!socket_address(socket_path_, addr)) {
+        return false;
+    }
+
+    // A socket file nobody answers on is left over from a daemon that died
+    struct stat info;
+    if (lstat(socket_path_.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+        int probe = connect_unix(socket_path_);
+        if (probe >= 0) {
+            close(probe);
+            std::cerr << "A coordinator is already running on " << socket_path_ << std::endl;
+            return false;
+        }
+        unlink(socket_path_.c_str());
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 64) != 0) {
+        std::cerr << "Cannot listen on " << socket_path_ << ": " << std::strerror(errno) << std::endl;
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+void CoordinatorServer::run(std::chrono::seconds interval, const std::function<void()>& maintenance) {
+    auto next_maintenance = std::chrono::steady_clock::now() + interval;
+    std::vector<pollfd> fds;
+
+    while (!stopping_) {
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& client : clients_) {
+            short events = client->written < client->out.size() ? POLLIN | POLLOUT : POLLIN;
+            fds.push_back({client->fd, events, 0});
+        }
+
+        // Wake up regularly to notice stop()
+        if (poll(fds.data(), fds.size(), 500) > 0) {
+            for (size_t i = 1; i < fds.size(); ++i) {
+                Client& client = *clients_[i - 1];
+                if (!client.closed && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                    read_client(client);
+                }
+                if (!client.closed && (fds[i].revents & POLLOUT)) {
+                    write_client(client);
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                accept_client();
+            }
+        }
+
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            if ((*it)->closed) {
+                close((*it)->fd);
+                it = clients_.erase(it);
+                std::cout << "Bot process disconnected (" << clients_.size() << " connected)" << std::endl;
+            } else {
+                ++it;
+            }
+        }
+
+        if (maintenance && interval.count() > 0 && std::chrono::steady_clock::now() >= next_maintenance) {
+            maintenance();
+            next_maintenance = std::chrono::steady_clock::now() + interval;
+        }
+    }
+}
+
+void CoordinatorServer::accept_client() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        // Catch the process up: the cluster's settings, then every cached translation
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        client->out = reset_frame(settings_.entries());
+        cache_.for_each([&client](const std::string& key, const std::string& value, int64_t expires_at) {
+            client->out += put_frame(key, value, expires_at);
+        });
+        clients_.push_back(std::move(client));
+        std::cout << "Bot process connected (" << clients_.size() << " connected)" << std::endl;
+    }
+}
+
+void CoordinatorServer::read_client(Client& client) {
+    bool open = read_frames(client.fd, client.in, [this, &client](const std::string& frame) {
+        handle_frame(client, frame);
+    });
+    client.closed = client.closed || !open;
+}
+
+void CoordinatorServer::write_client(Client& client) {
+    client.closed = !write_frames(client.fd, client.out, client.written);
+}
+
+void CoordinatorServer::handle_frame(Client& from, const std::string& frame) {
+    frames_received.add();
+    FrameReader reader(frame);
+
+    if (frame[0] == FRAME_PUT) {
+        std::string key;
+        std::string value;
+        int64_t expires_at = 0;
+        if (reader.str(key) && reader.str(value) && reader.pod(expires_at)) {
+            cache_.put_shared(key, std::move(value), expires_at);
+            broadcast(frame, &from);
+        }
+    } else if (frame[0] == FRAME_SETTINGS) {
+        // Back to the sender too, so every process applies changes in this order
+        SettingsChange change;
+        if (reader.change(change)) {
+            settings_.apply_shared(change);
+            broadcast(frame, nullptr);
+        }
+    }
+}
+
+void CoordinatorServer::broadcast(const std::string& frame, const Client* except) {
+    uint32_t length = static_cast<uint32_t>(frame.size());
+    for (const auto& client : clients_) {
+        if (client.get() == except || client->closed) {
+            continue;
+        }
+        // Cut off a process that stopped reading; it is caught up when it reconnects
+        if (client->out.size() - client->written > MAX_BACKLOG_BYTES) {
+            std::cerr << "Dropping a bot process that fell behind" << std::endl;
+            client->closed = true;
+            continue;
+        }
+        client->out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        client->out += frame;
+        frames_sent.add();
+    }
+}
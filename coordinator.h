@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "settings_store.h"
+#include "translation_cache.h"
+
+// Keeps the translation caches and auto-translate settings of the bot
+// processes in a cluster in step. Every cache entry one process stores is
+// copied to the others, so lookups never leave the process. Settings
+// changes are applied by every process, the one that made them included,
+// in the order the coordinator received them, so all processes end up with
+// the same settings.
+class Coordinator {
+public:
+    virtual ~Coordinator() = default;
+
+    // Share cache entries and settings changes with the other processes
+    // from now on. Both must outlive the coordinator.
+    virtual void join(TranslationCache& cache, SettingsStore& settings) = 0;
+};
+
+struct CoordinatorStats {
+    bool connected = false;
+    uint64_t connects = 0;
+    uint64_t frames_sent = 0;
+    uint64_t frames_received = 0;
+    uint64_t dropped_puts = 0;  // Cache entries not shared while disconnected
+};
+
+// Client end of the coordinator daemon (CoordinatorServer) on a Unix socket.
+// A thread of its own does the socket I/O and reconnects after
+// reconnect_delay when the daemon goes away. On every connect the daemon
+// sends the cluster's settings, which replace the local ones, and its cached
+// translations. Settings changes made while disconnected are sent on
+// reconnect; cache entries are not.
+class SocketCoordinator : public Coordinator {
+public:
+    SocketCoordinator(std::string socket_path, std::chrono::milliseconds reconnect_delay);
+    ~SocketCoordinator() override;
+
+    SocketCoordinator(const SocketCoordinator&) = delete;
+    SocketCoordinator& operator=(const SocketCoordinator&) = delete;
+
+    // One process, so join only once
+    void join(TranslationCache& cache, SettingsStore& settings) override;
+
+    // Wait until the cluster's settings have arrived. False on timeout.
+    bool wait_synced(std::chrono::milliseconds timeout);
+
+    CoordinatorStats stats() const;
+
+private:
+    struct State;
+
+    void run();
+    void handle_frame(const std::string& frame);
+
+    const std::string socket_path_;
+    const std::chrono::milliseconds reconnect_delay_;
+    TranslationCache* cache_ = nullptr;
+    SettingsStore* settings_ = nullptr;
+
+    // Shared with the cache and settings listeners, which may outlive this
+    std::shared_ptr<State> state_;
+    std::thread thread_;
+};
+
+// In-process stand-in for the daemon, for tests and benchmarks: processes
+// joined to it share the way separate ones would through a
+// SocketCoordinator, with changes relayed on a thread of its own.
+class LocalCoordinator : public Coordinator {
+public:
+    LocalCoordinator();
+    ~LocalCoordinator() override;
+
+    LocalCoordinator(const LocalCoordinator&) = delete;
+    LocalCoordinator& operator=(const LocalCoordinator&) = delete;
+
+    void join(TranslationCache& cache, SettingsStore& settings) override;
+
+    // Wait until everything shared so far has reached every joined process
+    void flush();
+
+private:
+    struct Hub;
+
+    std::shared_ptr<Hub> hub_;
+    std::thread thread_;
+};
+
+// The coordinator daemon. Accepts bot processes on a Unix socket, relays
+// cache entries and settings changes between them, and keeps the cluster's
+// settings (persisted by settings) and a copy of the cache for processes
+// that connect later. Runs on the thread that calls run().
+class CoordinatorServer {
+public:
+    CoordinatorServer(std::string socket_path, TranslationCache& cache, SettingsStore& settings);
+    ~CoordinatorServer();
+
+    CoordinatorServer(const CoordinatorServer&) = delete;
+    CoordinatorServer& operator=(const CoordinatorServer&) = delete;
+
+    // Listen on the socket, replacing a stale socket file
+    bool start();
+
+    // Serve until stop() is called, calling maintenance every interval
+    void run(std::chrono::seconds interval = std::chrono::seconds(0), const std::function<void()>& maintenance = nullptr);
+
+    // Safe to call from any thread and from signal handlers
+    void stop() { stopping_ = true; }
+
+private:
+    struct Client {
+        int fd;
+        std::string in;
+        std::string out;
+        size_t written = 0;  // Bytes of out already sent
+        bool closed = false;
+    };
+
+    void accept_client();
+    void read_client(Client& client);
+    void write_client(Client& client);
+    void handle_frame(Client& from, const std::string& frame);
+    void broadcast(const std::string& frame, const Client* except);
+
+    const std::string socket_path_;
+    TranslationCache& cache_;
+    SettingsStore& settings_;
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::vector<std::unique_ptr<Client>> clients_;
+};
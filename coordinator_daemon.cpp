@@ -0,0 +1,68 @@
+// Coordinator daemon for running the bot as several processes (cluster
+// mode). Start it before the bot processes, with the same .env, and point
+// every bot process at it with COORDINATOR_SOCKET.
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+
+#include "config.h"
+#include "coordinator.h"
+
+static CoordinatorServer* running = nullptr;
+
+static void handle_signal(int) {
+    if (running) {
+        running->stop();
+    }
+}
+
+int main() {
+    load_config(".env");
+
+    // The daemon owns the cluster's settings; bot processes keep none on disk
+    SettingsStore settings(config_string("SETTINGS_FILE", "bot_settings.json"));
+    if (settings.load()) {
+        std::cout << "Auto-translate enabled in " << Settings::count(settings.snapshot()->channels) << " channels" << std::endl;
+    }
+
+    // Handed to every process that connects, so new processes start warm
+    TranslationCache cache(
+        std::max<long>(config_int("CACHE_MAX_BYTES", 32 * 1024 * 1024), 1),
+        std::chrono::seconds(std::max<long>(config_int("CACHE_TTL_SECONDS", 24 * 60 * 60), 1)));
+    std::string cache_file = config_string("CACHE_SNAPSHOT_FILE");
+    if (!cache_file.empty() && cache.load(cache_file)) {
+        std::cout << "Loaded " << cache.stats().entries << " cached translations" << std::endl;
+    }
+
+    std::string socket_path = config_string("COORDINATOR_SOCKET", "translator-coordinator.sock");
+    CoordinatorServer server(socket_path, cache, settings);
+    if (!server.start()) {
+        return 1;
+    }
+    std::cout << "Coordinating bot processes on " << socket_path << std::endl;
+
+    running = &server;
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    // Fold the settings change log into the settings file and snapshot the cache
+    long compact_interval = config_int("SETTINGS_COMPACT_INTERVAL_SECONDS", 300);
+    long snapshot_interval = config_int("CACHE_SNAPSHOT_INTERVAL_SECONDS", 300);
+    auto last_snapshot = std::chrono::steady_clock::now();
+    long interval = cache_file.empty() ? compact_interval : std::min(compact_interval, snapshot_interval);
+    server.run(std::chrono::seconds(interval), [&] {
+        settings.compact();
+        auto now = std::chrono::steady_clock::now();
+        if (!cache_file.empty() && now - last_snapshot >= std::chrono::seconds(snapshot_interval)) {
+            cache.save(cache_file);
+            last_snapshot = now;
+        }
+    });
+    running = nullptr;
+
+    settings.compact();
+    if (!cache_file.empty()) {
+        cache.save(cache_file);
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "event_loop.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "metrics.h"
+
+static Histogram timer_lag("event_loop_timer_lag_seconds", "Delay between a timer falling due and the event loop running it");
+
+// Connections kept open per host. Requests beyond what these can multiplex
+// wait inside curl rather than opening yet more sockets.
+static const long MAX_HOST_CONNECTIONS = 16;
+
+// Longest the loop sleeps with nothing due, so a missed wakeup is never fatal
+static const int MAX_POLL_MS = 1000;
+
+// Everything on the loop runs through here: one throwing callback must not
+// take the thread, and with it every pending request, down
+template <typename Fn>
+static void run_guarded(Fn&& fn) {
+    try {
+        fn();
+    } catch (const std::exception& e) {
+        std::cerr << "Event loop callback error: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Event loop callback error: unknown exception" << std::endl;
+    }
+}
+
+EventLoop::EventLoop() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi_ = curl_multi_init();
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+    thread_ = std::thread(&EventLoop::run, this);
+}
+
+EventLoop::~EventLoop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    curl_multi_wakeup(multi_);
+    thread_.join();
+    curl_multi_cleanup(multi_);
+    curl_global_cleanup();
+}
+
+void EventLoop::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        posted_.push_back(std::move(fn));
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void EventLoop::post_after(std::chrono::steady_clock::duration delay, std::function<void()> fn) {
+    if (delay <= std::chrono::steady_clock::duration::zero()) {
+        post(std::move(fn));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.push(Timer{std::chrono::steady_clock::now() + delay, next_sequence_++, std::move(fn)});
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void EventLoop::add_transfer(CURL* handle, std::function<void(CURLcode)> done) {
+    in_flight_.fetch_add(1, std::memory_order_relaxed);
+
+    // The multi handle belongs to the loop thread, so add it from there
+    post([this, handle, done = std::move(done)]() mutable {
+        transfers_.emplace(handle, std::move(done));
+        CURLMcode added = curl_multi_add_handle(multi_, handle);
+        if (added != CURLM_OK) {
+            std::cerr << "Cannot start request: " << curl_multi_strerror(added) << std::endl;
+            auto it = transfers_.find(handle);
+            auto callback = std::move(it->second);
+            transfers_.erase(it);
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            run_guarded([&]() { callback(CURLE_FAILED_INIT); });
+        }
+    });
+}
+
+void EventLoop::finish_transfers() {
+    int queued = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi_, &queued)) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+
+        CURL* handle = msg->easy_handle;
+        CURLcode result = msg->data.result;
+        curl_multi_remove_handle(multi_, handle);
+
+        auto it = transfers_.find(handle);
+        if (it == transfers_.end()) {
+            continue;
+        }
+        auto done = std::move(it->second);
+        transfers_.erase(it);
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        run_guarded([&]() { done(result); });
+    }
+}
+
+void EventLoop::run() {
+    std::vector<std::function<void()>> ready;
+
+    while (true) {
+        int timeout_ms = MAX_POLL_MS;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                break;
+            }
+
+            ready.swap(posted_);
+
+            auto now = std::chrono::steady_clock::now();
+            while (!timers_.empty() && timers_.top().due <= now) {
+                timer_lag.observe(now - timers_.top().due);
+                ready.push_back(std::move(const_cast<Timer&>(timers_.top()).fn));
+                timers_.pop();
+            }
+            if (!timers_.empty()) {
+                auto until = std::chrono::duration_cast<std::chrono::milliseconds>(timers_.top().due - now);
+                timeout_ms = std::min<int>(timeout_ms, until.count() + 1);
+            }
+        }
+
+        for (auto& fn : ready) {
+            run_guarded(fn);
+        }
+        ready.clear();
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        finish_transfers();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!posted_.empty() || stopping_) {
+                continue;
+            }
+        }
+        curl_multi_poll(multi_, nullptr, 0, timeout_ms, nullptr);
+    }
+
+    // Fail whatever is still in flight so nobody waits on it forever
+    for (auto& [handle, done] : transfers_) {
+        curl_multi_remove_handle(multi_, handle);
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+        run_guarded([&]() { done(CURLE_ABORTED_BY_CALLBACK); });
+    }
+    transfers_.clear();
+}
+
+EventLoop& event_loop() {
+    static EventLoop loop;
+    return loop;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A single thread that drives every in-flight HTTP transfer through one curl
+// multi handle and runs timers and posted callbacks in between. Nothing
+// waits on a thread per request, so one loop can keep thousands of
+// translations in flight. Callbacks run on the loop thread and must not block.
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // Run fn on the loop thread as soon as possible
+    void post(std::function<void()> fn);
+
+    // Run fn on the loop thread once delay has passed
+    void post_after(std::chrono::steady_clock::duration delay, std::function<void()> fn);
+
+    // Hand a prepared easy handle to the loop. done(result) runs on the loop
+    // thread after the transfer finishes; the handle is the caller's again then.
+    void add_transfer(CURL* handle, std::function<void(CURLcode result)> done);
+
+    // True on the loop thread, where blocking on a translation would deadlock
+    bool in_loop_thread() const { return std::this_thread::get_id() == thread_.get_id(); }
+
+    size_t transfers_in_flight() const { return in_flight_.load(std::memory_order_relaxed); }
+
+private:
+    struct Timer {
+        std::chrono::steady_clock::time_point due;
+        uint64_t sequence;  // Keeps timers with the same deadline in order
+        std::function<void()> fn;
+
+        bool operator>(const Timer& other) const {
+            return due != other.due ? due > other.due : sequence > other.sequence;
+        }
+    };
+
+    void run();
+    void finish_transfers();
+
+    CURLM* multi_;
+
+    std::mutex mutex_;
+    std::vector<std::function<void()>> posted_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    uint64_t next_sequence_ = 0;
+    bool stopping_ = false;
+
+    // Only touched on the loop thread
+    std::unordered_map<CURL*, std::function<void(CURLcode)>> transfers_;
+    std::atomic<size_t> in_flight_{0};
+
+    std::thread thread_;  // Last, so everything it touches is initialized first
+};
+
+// Process-wide loop that runs all upstream requests
+EventLoop& event_loop();
@@ -0,0 +1,331 @@
+#include "guild_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "config.h"
+#include "metrics.h"
+
+static Histogram queue_wait("scheduler_queue_wait_seconds", "Time auto-translate messages wait for their guild's turn");
+static Counter dropped_quota("scheduler_dropped_total", "Auto-translate messages shed by the guild scheduler", "reason=\"quota\"");
+static Counter dropped_queue_full("scheduler_dropped_total", "Auto-translate messages shed by the guild scheduler", "reason=\"queue_full\"");
+
+// Deficit grows by at least this much per turn, so a tiny weight still progresses
+static const double MIN_WEIGHT = 0.01;
+
+// Guilds with nothing queued or running for this long are forgotten; by then
+// their quota bucket has refilled, so a fresh entry behaves the same
+static const std::chrono::minutes GUILD_IDLE(10);
+
+static bool parse_field(const std::string& field, double& value) {
+    if (field.empty()) {
+        return true;
+    }
+    try {
+        value = std::stod(field);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::unordered_map<uint64_t, GuildLimits> parse_guild_limits(const std::string& value, const GuildLimits& defaults) {
+    std::unordered_map<uint64_t, GuildLimits> overrides;
+    std::stringstream entries(value);
+    std::string entry;
+
+    while (std::getline(entries, entry, ',')) {
+        if (entry.find_first_not_of(' ') == std::string::npos) {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream parts(entry);
+        std::string field;
+        while (std::getline(parts, field, ':')) {
+            fields.push_back(field);
+        }
+        fields.resize(4);
+
+        GuildLimits limits = defaults;
+        double max_in_flight = limits.max_in_flight;
+        uint64_t guild_id = 0;
+        try {
+            guild_id = std::stoull(fields[0]);
+        } catch (const std::exception&) {
+        }
+
+        if (guild_id == 0 || !parse_field(fields[1], limits.weight) || !parse_field(fields[2], max_in_flight) ||
+            !parse_field(fields[3], limits.quota_per_minute)) {
+            std::cerr << "Ignoring malformed GUILD_LIMITS entry '" << entry << "'" << std::endl;
+            continue;
+        }
+        limits.max_in_flight = std::max(1.0, max_in_flight);
+        overrides[guild_id] = limits;
+    }
+
+    return overrides;
+}
+
+GuildScheduler::GuildScheduler(SchedulerOptions options)
+    : options_(std::move(options)), pruned_at_(std::chrono::steady_clock::now()) {
+    collector_id_ = add_metrics_collector([this](std::ostream& out) { write_metrics(out); });
+}
+
+GuildScheduler::~GuildScheduler() {
+    remove_metrics_collector(collector_id_);
+}
+
+GuildScheduler::Guild& GuildScheduler::guild(uint64_t guild_id) {
+    auto it = guilds_.find(guild_id);
+    if (it != guilds_.end()) {
+        return it->second;
+    }
+
+    Guild& g = guilds_[guild_id];
+    auto found = options_.overrides.find(guild_id);
+    g.limits = found != options_.overrides.end() ? found->second : options_.defaults;
+    g.quota_tokens = g.limits.quota_per_minute;
+    g.refilled_at = std::chrono::steady_clock::now();
+    return g;
+}
+
+// Token bucket holding up to one minute of quota. A message with more
+// targets than a minute's quota costs a full bucket rather than never fitting.
+bool GuildScheduler::take_quota(Guild& g, uint32_t cost, std::chrono::steady_clock::time_point now) {
+    if (g.limits.quota_per_minute <= 0) {
+        return true;
+    }
+
+    // A guild created during this submit was stamped slightly after now
+    double elapsed = std::max(0.0, std::chrono::duration<double>(now - g.refilled_at).count());
+    g.quota_tokens = std::min(g.limits.quota_per_minute, g.quota_tokens + elapsed * g.limits.quota_per_minute / 60.0);
+    g.refilled_at = now;
+
+    double needed = std::min<double>(cost, g.limits.quota_per_minute);
+    if (g.quota_tokens < needed) {
+        return false;
+    }
+    g.quota_tokens -= needed;
+    return true;
+}
+
+bool GuildScheduler::submit(uint64_t guild_id, uint32_t cost, Job job, std::function<void()> on_drop) {
+    auto now = std::chrono::steady_clock::now();
+    std::function<void()> shed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        prune(now);
+        Guild& g = guild(guild_id);
+        g.last_active = now;
+
+        if (!take_quota(g, cost, now)) {
+            ++g.dropped_quota;
+            ++dropped_quota_;
+            dropped_quota.add();
+            return false;
+        }
+
+        // Shed the guild's own oldest message; other guilds are unaffected
+        if (g.queue.size() >= std::max<size_t>(g.limits.max_queued, 1)) {
+            shed = std::move(g.queue.front().on_drop);
+            g.queue.pop_front();
+            --queued_;
+            ++g.dropped_queue_full;
+            ++dropped_queue_full_;
+            dropped_queue_full.add();
+        }
+
+        g.queue.push_back(Entry{std::move(job), std::move(on_drop), std::max<uint32_t>(cost, 1), now});
+        ++queued_;
+        if (!g.active) {
+            g.active = true;
+            ring_.push_back(guild_id);
+        }
+    }
+
+    if (shed) {
+        shed();
+    }
+    dispatch();
+    return true;
+}
+
+// Take every job that may start now, in deficit round-robin order
+std::deque<GuildScheduler::Started> GuildScheduler::pick() {
+    std::deque<Started> started;
+    size_t capped_turns = 0;
+
+    while (in_flight_ < options_.max_in_flight && !ring_.empty() && capped_turns < ring_.size()) {
+        uint64_t guild_id = ring_.front();
+        ring_.pop_front();
+        Guild& g = guilds_[guild_id];
+
+        // A guild at its cap skips its turn without banking credit for it
+        if (g.in_flight >= g.limits.max_in_flight) {
+            ++capped_turns;
+            ring_.push_back(guild_id);
+            continue;
+        }
+        capped_turns = 0;
+
+        g.deficit += options_.quantum * std::max(g.limits.weight, MIN_WEIGHT);
+        while (!g.queue.empty() && g.queue.front().cost <= g.deficit &&
+               g.in_flight < g.limits.max_in_flight && in_flight_ < options_.max_in_flight) {
+            Entry entry = std::move(g.queue.front());
+            g.queue.pop_front();
+            g.deficit -= entry.cost;
+            ++g.in_flight;
+            ++g.dispatched;
+            ++in_flight_;
+            --queued_;
+            ++dispatched_;
+            started.push_back({guild_id, std::move(entry)});
+        }
+
+        if (g.queue.empty()) {
+            // Credit does not carry over an idle period
+            g.deficit = 0.0;
+            g.active = false;
+        } else {
+            ring_.push_back(guild_id);
+        }
+    }
+
+    return started;
+}
+
+void GuildScheduler::dispatch() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Jobs that finish while starting would otherwise recurse into here
+        if (dispatching_) {
+            redispatch_ = true;
+            return;
+        }
+        dispatching_ = true;
+    }
+
+    while (true) {
+        std::deque<Started> started;
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            started = pick();
+            if (started.empty() && !redispatch_) {
+                dispatching_ = false;
+                return;
+            }
+            redispatch_ = false;
+
+            for (const auto& s : started) {
+                double waited = std::chrono::duration<double>(now - s.entry.enqueued).count();
+                guilds_[s.guild_id].wait_seconds += waited;
+                queue_wait.observe(waited);
+            }
+        }
+
+        for (auto& s : started) {
+            uint64_t guild_id = s.guild_id;
+            auto enqueued = s.entry.enqueued;
+            try {
+                s.entry.job([this, guild_id, enqueued]() { finish(guild_id, enqueued); });
+            } catch (const std::exception& e) {
+                std::cerr << "Scheduled task error: " << e.what() << std::endl;
+                finish(guild_id, enqueued);
+            }
+        }
+    }
+}
+
+void GuildScheduler::finish(uint64_t guild_id, std::chrono::steady_clock::time_point enqueued) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        Guild& g = guilds_[guild_id];
+        --g.in_flight;
+        --in_flight_;
+        ++g.completed;
+        g.last_active = now;
+        g.latency_seconds += std::chrono::duration<double>(now - enqueued).count();
+    }
+    dispatch();
+}
+
+// Drop idle guilds so their per-guild series do not pile up
+void GuildScheduler::prune(std::chrono::steady_clock::time_point now) {
+    if (now - pruned_at_ < std::chrono::minutes(1)) {
+        return;
+    }
+    pruned_at_ = now;
+
+    for (auto it = guilds_.begin(); it != guilds_.end();) {
+        const Guild& g = it->second;
+        bool idle = g.queue.empty() && g.in_flight == 0 && !g.active && now - g.last_active >= GUILD_IDLE;
+        it = idle ? guilds_.erase(it) : std::next(it);
+    }
+}
+
+SchedulerStats GuildScheduler::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    SchedulerStats s;
+    s.queued = queued_;
+    s.in_flight = in_flight_;
+    s.active_guilds = ring_.size();
+    s.dispatched = dispatched_;
+    s.dropped_quota = dropped_quota_;
+    s.dropped_queue_full = dropped_queue_full_;
+    return s;
+}
+
+void GuildScheduler::write_metrics(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out << "# HELP scheduler_guild_queued Auto-translate messages waiting per guild\n"
+        << "# TYPE scheduler_guild_queued gauge\n";
+    for (const auto& [id, g] : guilds_) {
+        out << "scheduler_guild_queued{guild=\"" << id << "\"} " << g.queue.size() << "\n";
+    }
+
+    out << "# HELP scheduler_guild_in_flight Auto-translate messages being translated per guild\n"
+        << "# TYPE scheduler_guild_in_flight gauge\n";
+    for (const auto& [id, g] : guilds_) {
+        out << "scheduler_guild_in_flight{guild=\"" << id << "\"} " << g.in_flight << "\n";
+    }
+
+    out << "# HELP scheduler_guild_wait_seconds Time auto-translate messages waited for their turn, per guild\n"
+        << "# TYPE scheduler_guild_wait_seconds summary\n";
+    for (const auto& [id, g] : guilds_) {
+        out << "scheduler_guild_wait_seconds_sum{guild=\"" << id << "\"} " << g.wait_seconds << "\n"
+            << "scheduler_guild_wait_seconds_count{guild=\"" << id << "\"} " << g.dispatched << "\n";
+    }
+
+    out << "# HELP scheduler_guild_latency_seconds Time from queueing to finished translation, per guild\n"
+        << "# TYPE scheduler_guild_latency_seconds summary\n";
+    for (const auto& [id, g] : guilds_) {
+        out << "scheduler_guild_latency_seconds_sum{guild=\"" << id << "\"} " << g.latency_seconds << "\n"
+            << "scheduler_guild_latency_seconds_count{guild=\"" << id << "\"} " << g.completed << "\n";
+    }
+
+    out << "# HELP scheduler_guild_dropped_total Auto-translate messages shed per guild\n"
+        << "# TYPE scheduler_guild_dropped_total counter\n";
+    for (const auto& [id, g] : guilds_) {
+        out << "scheduler_guild_dropped_total{guild=\"" << id << "\",reason=\"quota\"} " << g.dropped_quota << "\n"
+            << "scheduler_guild_dropped_total{guild=\"" << id << "\",reason=\"queue_full\"} "
+            << g.dropped_queue_full << "\n";
+    }
+}
+
+SchedulerOptions scheduler_options_from_config() {
+    SchedulerOptions options;
+    options.max_in_flight = std::max<long>(config_int("SCHEDULER_MAX_IN_FLIGHT", options.max_in_flight), 1);
+    options.quantum = std::max<long>(config_int("SCHEDULER_QUANTUM", options.quantum), 1);
+    options.defaults.max_in_flight = std::max<long>(config_int("GUILD_MAX_IN_FLIGHT", options.defaults.max_in_flight), 1);
+    options.defaults.max_queued = std::max<long>(config_int("GUILD_MAX_QUEUED", options.defaults.max_queued), 1);
+    options.defaults.quota_per_minute = config_double("GUILD_QUOTA_PER_MINUTE", options.defaults.quota_per_minute);
+    options.overrides = parse_guild_limits(config_string("GUILD_LIMITS"), options.defaults);
+    return options;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+struct GuildLimits {
+    double weight = 1.0;           // Share of dispatch relative to other guilds
+    size_t max_in_flight = 32;     // Messages of this guild being translated at once
+    size_t max_queued = 128;       // Messages waiting; the oldest is shed beyond this
+    double quota_per_minute = 0;   // Translations (message x target) per minute, 0 = unlimited
+};
+
+struct SchedulerOptions {
+    size_t max_in_flight = 512;  // Messages being translated at once across all guilds
+    uint32_t quantum = 4;        // Translations a guild of weight 1 may start per round
+    GuildLimits defaults;
+    std::unordered_map<uint64_t, GuildLimits> overrides;  // By guild ID
+};
+
+// Parse GUILD_LIMITS-style overrides: comma-separated
+// "guild_id:weight:max_in_flight:quota_per_minute" entries, where empty
+// fields keep the defaults
+std::unordered_map<uint64_t, GuildLimits> parse_guild_limits(const std::string& value, const GuildLimits& defaults);
+
+struct SchedulerStats {
+    size_t queued = 0;
+    size_t in_flight = 0;
+    size_t active_guilds = 0;  // Guilds with queued work
+    uint64_t dispatched = 0;
+    uint64_t dropped_quota = 0;
+    uint64_t dropped_queue_full = 0;
+};
+
+// Fair dispatch of auto-translate work across guilds. Each guild has its
+// own queue, and queues are served by deficit round-robin weighted by the
+// guild's weight, with a message costing one unit per target language. A
+// guild with a server-wide entry and a flood of messages therefore gets its
+// share and no more, while quiet guilds are served on their next turn.
+//
+// A job starts its work and calls done() once that work has finished (or
+// failed), which frees its slot. Slash commands do not go through here;
+// they take the worker pool's priority lane.
+class GuildScheduler {
+public:
+    using Done = std::function<void()>;
+    using Job = std::function<void(Done done)>;
+
+    explicit GuildScheduler(SchedulerOptions options);
+    ~GuildScheduler();
+
+    GuildScheduler(const GuildScheduler&) = delete;
+    GuildScheduler& operator=(const GuildScheduler&) = delete;
+
+    // Queue a job costing cost translations. Returns false if it was refused
+    // because the guild is over its quota; on_drop runs for a queued job
+    // that is later shed to make room.
+    bool submit(uint64_t guild_id, uint32_t cost, Job job, std::function<void()> on_drop = nullptr);
+
+    SchedulerStats stats();
+
+private:
+    struct Entry {
+        Job job;
+        std::function<void()> on_drop;
+        uint32_t cost;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    struct Guild {
+        GuildLimits limits;
+        std::deque<Entry> queue;
+        double deficit = 0.0;
+        size_t in_flight = 0;
+        bool active = false;  // In the round-robin ring
+        std::chrono::steady_clock::time_point last_active;
+
+        double quota_tokens = 0.0;
+        std::chrono::steady_clock::time_point refilled_at;
+
+        uint64_t dispatched = 0;
+        uint64_t dropped_quota = 0;
+        uint64_t dropped_queue_full = 0;
+        uint64_t completed = 0;
+        double wait_seconds = 0.0;     // Queued time of dispatched jobs
+        double latency_seconds = 0.0;  // Submit to done of completed jobs
+    };
+
+    struct Started {
+        uint64_t guild_id;
+        Entry entry;
+    };
+
+    Guild& guild(uint64_t guild_id);
+    bool take_quota(Guild& g, uint32_t cost, std::chrono::steady_clock::time_point now);
+    std::deque<Started> pick();
+    void dispatch();
+    void finish(uint64_t guild_id, std::chrono::steady_clock::time_point enqueued);
+    void prune(std::chrono::steady_clock::time_point now);
+    void write_metrics(std::ostream& out);
+
+    const SchedulerOptions options_;
+
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Guild> guilds_;
+    std::deque<uint64_t> ring_;  // Guilds with queued work, in turn order
+    size_t in_flight_ = 0;
+    size_t queued_ = 0;
+    bool dispatching_ = false;
+    bool redispatch_ = false;
+    std::chrono::steady_clock::time_point pruned_at_;
+
+    uint64_t dispatched_ = 0;
+    uint64_t dropped_quota_ = 0;
+    uint64_t dropped_queue_full_ = 0;
+
+    uint64_t collector_id_ = 0;
+};
+
+// Scheduler options from SCHEDULER_* and GUILD_* settings
+SchedulerOptions scheduler_options_from_config();
@@ -0,0 +1,231 @@
+#include "http_client.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "event_loop.h"
+#include "metrics.h"
+
+static Counter http_ok("http_requests_total", "Upstream HTTP requests by outcome", "result=\"ok\"");
+static Counter http_error_status("http_requests_total", "Upstream HTTP requests by outcome", "result=\"http_error\"");
+static Counter http_failed("http_requests_total", "Upstream HTTP requests by outcome", "result=\"failed\"");
+static Counter http_rate_limited("http_rate_limited_total", "Upstream responses with status 429");
+static Histogram http_connect("http_phase_seconds", "Time spent in each phase of an upstream request", "phase=\"connect\"");
+static Histogram http_tls("http_phase_seconds", "Time spent in each phase of an upstream request", "phase=\"tls\"");
+static Histogram http_transfer("http_phase_seconds", "Time spent in each phase of an upstream request", "phase=\"transfer\"");
+static Histogram http_total("http_request_seconds", "Total time of upstream requests");
+
+// Response buffers start at this size and are not kept once they grow past the limit
+static const size_t INITIAL_BUFFER_BYTES = 4096;
+static const size_t MAX_SPARE_BUFFER_BYTES = 64 * 1024;
+
+// Curl write callback
+static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+HttpClient::HttpClient(size_t max_idle_handles) : max_idle_handles_(max_idle_handles) {
+    // curl_global_init is reference counted, so this is safe alongside main()
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    share_ = curl_share_init();
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HttpClient::lock_share);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HttpClient::unlock_share);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+HttpClient::~HttpClient() {
+    for (CURL* handle : idle_handles_) {
+        curl_easy_cleanup(handle);
+    }
+    curl_share_cleanup(share_);
+    curl_global_cleanup();
+}
+
+void HttpClient::lock_share(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<HttpClient*>(userptr)->share_locks_[data].lock();
+}
+
+void HttpClient::unlock_share(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<HttpClient*>(userptr)->share_locks_[data].unlock();
+}
+
+CURL* HttpClient::acquire_handle() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (!idle_handles_.empty()) {
+            CURL* handle = idle_handles_.back();
+            idle_handles_.pop_back();
+            return handle;
+        }
+    }
+
+    CURL* handle = curl_easy_init();
+    if (!handle) {
+        return nullptr;
+    }
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "Mozilla/5.0");
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, 5000L);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, 15000L);
+    return handle;
+}
+
+void HttpClient::release_handle(CURL* handle) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (idle_handles_.size() < max_idle_handles_) {
+            idle_handles_.push_back(handle);
+            return;
+        }
+    }
+    curl_easy_cleanup(handle);
+}
+
+std::string HttpClient::take_buffer() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (spare_buffers_.empty()) {
+        std::string buffer;
+        buffer.reserve(INITIAL_BUFFER_BYTES);
+        return buffer;
+    }
+    std::string buffer = std::move(spare_buffers_.back());
+    spare_buffers_.pop_back();
+    return buffer;
+}
+
+void HttpClient::recycle_buffer(std::string&& buffer) {
+    // Keep neither moved-from nor oversized buffers
+    if (buffer.capacity() < INITIAL_BUFFER_BYTES || buffer.capacity() > MAX_SPARE_BUFFER_BYTES) {
+        return;
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (spare_buffers_.size() < max_idle_handles_ * 4) {
+        spare_buffers_.push_back(std::move(buffer));
+    }
+}
+
+// Point a pooled handle at a request. Returns the header list, which must
+// stay alive until the transfer is done.
+curl_slist* HttpClient::prepare(CURL* handle, const HttpRequest& request, HttpResponse& response) {
+    curl_slist* headers = nullptr;
+
+    curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &response.body);
+    if (request.body.empty()) {
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    } else {
+        headers = curl_slist_append(headers, ("Content-Type: " + request.content_type).c_str());
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDS, request.body.c_str());
+    }
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+    return headers;
+}
+
+HttpResponse HttpClient::get(const std::string& url) {
+    return send(HttpRequest{url, "", ""});
+}
+
+HttpResponse HttpClient::send(const HttpRequest& request) {
+    HttpResponse response;
+
+    CURL* handle = acquire_handle();
+    if (!handle) {
+        response.error = CURLE_FAILED_INIT;
+        return response;
+    }
+
+    curl_slist* headers = prepare(handle, request, response);
+    finish(handle, curl_easy_perform(handle), response);
+    curl_slist_free_all(headers);
+    return response;
+}
+
+void HttpClient::finish(CURL* handle, CURLcode result, HttpResponse& response) {
+    response.error = result;
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status);
+
+    // Timings are cumulative from the start of the request, in microseconds.
+    // Connect and TLS are zero when an existing connection was reused.
+    curl_off_t connect = 0;
+    curl_off_t tls = 0;
+    curl_off_t total = 0;
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+    if (connect > 0) {
+        http_connect.observe(connect / 1e6);
+    }
+    if (tls > connect) {
+        http_tls.observe((tls - connect) / 1e6);
+    }
+    http_transfer.observe((total - std::max(connect, tls)) / 1e6);
+    http_total.observe(total / 1e6);
+
+    if (result != CURLE_OK) {
+        http_failed.add();
+    } else if (response.ok()) {
+        http_ok.add();
+    } else {
+        http_error_status.add();
+    }
+    if (response.status == 429) {
+        http_rate_limited.add();
+    }
+
+    if (result == CURLE_OK) {
+        release_handle(handle);
+    } else {
+        // Don't hand a handle with a broken connection back to the pool
+        curl_easy_cleanup(handle);
+    }
+}
+
+void HttpClient::send_async(HttpRequest request, std::function<void(HttpResponse&)> on_complete) {
+    struct Transfer {
+        HttpRequest request;
+        HttpResponse response;
+        curl_slist* headers = nullptr;
+        std::function<void(HttpResponse&)> on_complete;
+    };
+
+    auto transfer = std::make_shared<Transfer>();
+    transfer->request = std::move(request);
+    transfer->response.body = take_buffer();
+    transfer->on_complete = std::move(on_complete);
+
+    CURL* handle = acquire_handle();
+    if (!handle) {
+        event_loop().post([transfer]() {
+            transfer->response.error = CURLE_FAILED_INIT;
+            transfer->on_complete(transfer->response);
+        });
+        return;
+    }
+
+    // The request and response live in the transfer until curl is done with them
+    transfer->headers = prepare(handle, transfer->request, transfer->response);
+    event_loop().add_transfer(handle, [this, handle, transfer](CURLcode result) {
+        finish(handle, result, transfer->response);
+        curl_slist_free_all(transfer->headers);
+        transfer->on_complete(transfer->response);
+        recycle_buffer(std::move(transfer->response.body));
+    });
+}
+
+HttpClient& http_client() {
+    static HttpClient client;
+    return client;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Result of a single HTTP request
+struct HttpResponse {
+    CURLcode error = CURLE_OK;
+    long status = 0;
+    std::string body;
+
+    bool ok() const { return error == CURLE_OK && status >= 200 && status < 300; }
+};
+
+// A GET request, or a POST when body is set
+struct HttpRequest {
+    std::string url;
+    std::string body;
+    std::string content_type = "application/json";
+};
+
+// Thread-safe HTTP client backed by a pool of curl handles. All handles
+// share one DNS cache and TLS session cache through a share handle; async
+// requests also share the event loop's connection cache. Async response
+// bodies come from a pool of reused buffers.
+class HttpClient {
+public:
+    explicit HttpClient(size_t max_idle_handles = 16);
+    ~HttpClient();
+
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    HttpResponse get(const std::string& url);
+    HttpResponse send(const HttpRequest& request);
+
+    // Start a request on the event loop and return at once. on_complete runs
+    // on the loop thread when it finishes. Concurrent requests to the same
+    // host are multiplexed over HTTP/2 where possible.
+    void send_async(HttpRequest request, std::function<void(HttpResponse&)> on_complete);
+
+private:
+    CURL* acquire_handle();
+    void release_handle(CURL* handle);
+
+    // Response bodies are recycled so steady traffic stops allocating for them
+    std::string take_buffer();
+    void recycle_buffer(std::string&& buffer);
+    static curl_slist* prepare(CURL* handle, const HttpRequest& request, HttpResponse& response);
+    void finish(CURL* handle, CURLcode result, HttpResponse& response);
+
+    static void lock_share(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlock_share(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* share_;
+    std::mutex share_locks_[CURL_LOCK_DATA_LAST];
+
+    std::mutex pool_mutex_;
+    std::vector<CURL*> idle_handles_;
+    std::vector<std::string> spare_buffers_;
+    size_t max_idle_handles_;
+};
+
+// Process-wide client used for all translation requests
+HttpClient& http_client();
@@ -0,0 +1,244 @@
+#include "json_cursor.h"
+
+#include <cstdint>
+
+static void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+void JsonCursor::skip_space() {
+    while (pos_ < json_.size() &&
+           (json_[pos_] == ' ' || json_[pos_] == '\n' || json_[pos_] == '\r' || json_[pos_] == '\t')) {
+        ++pos_;
+    }
+}
+
+bool JsonCursor::fail() {
+    failed_ = true;
+    return false;
+}
+
+bool JsonCursor::consume(char c) {
+    skip_space();
+    if (pos_ < json_.size() && json_[pos_] == c) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+bool JsonCursor::peek(char c) {
+    skip_space();
+    return pos_ < json_.size() && json_[pos_] == c;
+}
+
+bool JsonCursor::next_item(bool& first) {
+    if (failed_) {
+        return false;
+    }
+    if (consume(']') || consume('}')) {
+        return false;
+    }
+    if (!first && !consume(',')) {
+        return fail();
+    }
+    first = false;
+    return true;
+}
+
+bool JsonCursor::read_key(std::string& key) {
+    key.clear();
+    return read_string(key) && (consume(':') || fail());
+}
+
+bool JsonCursor::read_hex4(uint32_t& value) {
+    if (pos_ + 4 > json_.size()) {
+        return fail();
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = json_[pos_++];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value |= c - 'A' + 10;
+        } else {
+            return fail();
+        }
+    }
+    return true;
+}
+
+bool JsonCursor::read_string(std::string& out) {
+    if (!consume('"')) {
+        return fail();
+    }
+
+    while (pos_ < json_.size()) {
+        // Copy the run up to the next quote or escape in one go
+        size_t run = pos_;
+        while (run < json_.size() && json_[run] != '"' && json_[run] != '\\') {
+            ++run;
+        }
+        out.append(json_.data() + pos_, run - pos_);
+        pos_ = run;
+        if (pos_ >= json_.size()) {
+            break;
+        }
+
+        if (json_[pos_++] == '"') {
+            return true;
+        }
+
+        if (pos_ >= json_.size()) {
+            break;
+        }
+        char escaped = json_[pos_++];
+        switch (escaped) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if (!read_hex4(cp)) {
+                    return false;
+                }
+                // A high surrogate should be followed by its low half
+                if (cp >= 0xD800 && cp < 0xDC00 && json_.substr(pos_, 2) == "\\u") {
+                    pos_ += 2;
+                    uint32_t low = 0;
+                    if (!read_hex4(low)) {
+                        return false;
+                    }
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else {
+                        append_utf8(out, 0xFFFD);
+                        cp = low;
+                    }
+                } else if (cp >= 0xD800 && cp < 0xE000) {
+                    cp = 0xFFFD;
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return fail();
+        }
+    }
+
+    return fail();
+}
+
+bool JsonCursor::skip_value() {
+    skip_space();
+    if (pos_ >= json_.size()) {
+        return fail();
+    }
+
+    char c = json_[pos_];
+    if (c == '"') {
+        for (++pos_; pos_ < json_.size(); ++pos_) {
+            if (json_[pos_] == '\\') {
+                ++pos_;
+            } else if (json_[pos_] == '"') {
+                ++pos_;
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    if (c == '[' || c == '{') {
+        // Track nesting only; strings are skipped so brackets inside them don't count
+        size_t depth = 0;
+        while (pos_ < json_.size()) {
+            char d = json_[pos_];
+            if (d == '"') {
+                if (!skip_value()) {
+                    return false;
+                }
+                continue;
+            }
+            ++pos_;
+            if (d == '[' || d == '{') {
+                ++depth;
+            } else if ((d == ']' || d == '}') && --depth == 0) {
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    // Number, true, false or null
+    size_t start = pos_;
+    while (pos_ < json_.size() && json_[pos_] != ',' && json_[pos_] != ']' && json_[pos_] != '}' &&
+           json_[pos_] != ' ' && json_[pos_] != '\n' && json_[pos_] != '\r' && json_[pos_] != '\t') {
+        ++pos_;
+    }
+    return pos_ > start || fail();
+}
+
+bool extract_google_translation(std::string_view body, std::string& translated, std::string& detected) {
+    JsonCursor c(body);
+    if (!c.consume('[')) {
+        return false;
+    }
+
+    bool first = true;
+    size_t index = 0;
+    while (c.next_item(first)) {
+        if (index == 0 && c.consume('[')) {
+            // Segments: [translated, original, ...]
+            bool first_segment = true;
+            while (c.next_item(first_segment)) {
+                if (!c.consume('[')) {
+                    c.skip_value();
+                    continue;
+                }
+                bool first_field = true;
+                for (size_t field = 0; c.next_item(first_field); ++field) {
+                    if (field == 0 && c.peek('"')) {
+                        c.read_string(translated);
+                    } else {
+                        c.skip_value();
+                    }
+                }
+            }
+        } else if (index == 2) {
+            if (c.peek('"')) {
+                detected.clear();
+                c.read_string(detected);
+            }
+            // Nothing needed past the detected language
+            return !c.failed();
+        } else {
+            c.skip_value();
+        }
+        ++index;
+    }
+
+    return !c.failed() && index > 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Forward-only reader over JSON text that decodes just the values asked
+// for and skips the rest in place, without building a document. Meant for
+// pulling a few fields out of large upstream responses.
+//
+//   JsonCursor c(body);
+//   bool first = true;
+//   if (c.consume('[')) {
+//       while (c.next_item(first)) { c.skip_value(); }
+//   }
+//   if (c.failed()) { ... }
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view json) : json_(json) {}
+
+    // Consume c (after any whitespace) if it is next
+    bool consume(char c);
+
+    // True if c is next, after any whitespace
+    bool peek(char c);
+
+    // Step to the next element of the array or object just entered with
+    // consume('[') or consume('{'). Returns false at its closing bracket,
+    // or on malformed input (see failed()). first must start out true.
+    bool next_item(bool& first);
+
+    // Read an object key and its colon; the value is next
+    bool read_key(std::string& key);
+
+    // Decode a string value, appending it to out
+    bool read_string(std::string& out);
+
+    // Skip over one value of any type
+    bool skip_value();
+
+    bool failed() const { return failed_; }
+    size_t offset() const { return pos_; }
+
+private:
+    void skip_space();
+    bool fail();
+    bool read_hex4(uint32_t& value);
+
+    std::string_view json_;
+    size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+// Pull the translated text (j[0][*][0], concatenated) and the detected
+// source language (j[2]) out of a translate_a/single response
+bool extract_google_translation(std::string_view body, std::string& translated, std::string& detected);
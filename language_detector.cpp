@@ -0,0 +1,331 @@
+#include "language_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// N-grams kept per language after training; rarer ones fall back to smoothing
+static const size_t PROFILE_SIZE = 2000;
+
+// Fewer letters than this is not enough to say anything useful
+static const uint32_t MIN_LETTERS = 3;
+
+// Naive Bayes over-counts evidence from overlapping n-grams; scores are
+// divided by this before turning them into probabilities
+static const float SCORE_TEMPERATURE = 6.0f;
+
+// Most confidence given to a script that several supported languages write
+// in (Arabic for Persian and Urdu, Devanagari for Marathi and Nepali, ...).
+// The script names the likeliest language but cannot rule the others out,
+// so this stays below any sensible LOCAL_DETECT_THRESHOLD.
+static const float SHARED_SCRIPT_CONFIDENCE = 0.5f;
+
+// Naive Bayes model for the languages sharing one script. Known n-grams are
+// kept sorted, each with a row of per-language log probabilities.
+struct ScriptModel {
+    Script script;
+    std::vector<std::string> codes;
+    std::vector<uint64_t> keys;
+    std::vector<float> log_probs;   // keys.size() x codes.size()
+    std::vector<std::vector<uint32_t>> alphabets;  // Sorted letters of each language
+};
+
+// Unigram keys are the code point itself; longer n-grams start above this
+static const uint64_t UNIGRAM_LIMIT = 1u << 21;
+
+static uint32_t to_lower(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    }
+    if (cp >= 0x00C0 && cp <= 0x00DE && cp != 0x00D7) {
+        return cp + 0x20;
+    }
+    if ((cp >= 0x0100 && cp <= 0x0137) || (cp >= 0x014A && cp <= 0x0177) ||
+        (cp >= 0x1E00 && cp <= 0x1EFF) || (cp >= 0x0460 && cp <= 0x04FF)) {
+        return (cp % 2 == 0) ? cp + 1 : cp;
+    }
+    if ((cp >= 0x0139 && cp <= 0x0148) || (cp >= 0x0179 && cp <= 0x017E)) {
+        return (cp % 2 == 1) ? cp + 1 : cp;
+    }
+    if (cp >= 0x0218 && cp <= 0x021B) {
+        return (cp % 2 == 0) ? cp + 1 : cp;
+    }
+    if (cp == 0x01A0 || cp == 0x01AF) {
+        return cp + 1;
+    }
+    if (cp == 0x0130) {
+        return 'i';
+    }
+    if (cp >= 0x0410 && cp <= 0x042F) {
+        return cp + 0x20;
+    }
+    if (cp >= 0x0400 && cp <= 0x040F) {
+        return cp + 0x50;
+    }
+    return cp;
+}
+
+// Call emit(key) for every 1-, 2- and 3-gram of the lowercased words written
+// in the given script. Words are padded with a space on each side.
+template <typename Emit>
+static void for_each_ngram(const std::string& text, Script script, Emit emit) {
+    const uint32_t SPACE = ' ';
+    uint32_t prev2 = 0;
+    uint32_t prev1 = SPACE;
+    bool in_word = false;
+
+    auto push = [&](uint32_t cp) {
+        if (cp != SPACE) {
+            emit(static_cast<uint64_t>(cp));
+        }
+        if (prev1 != 0) {
+            emit((static_cast<uint64_t>(prev1) << 21) | cp);
+        }
+        if (prev2 != 0) {
+            emit((static_cast<uint64_t>(prev2) << 42) | (static_cast<uint64_t>(prev1) << 21) | cp);
+        }
+        prev2 = prev1;
+        prev1 = cp;
+    };
+
+    size_t i = 0;
+    while (i < text.size()) {
+        uint32_t cp = 0;
+        size_t length = decode_utf8(text, i, cp);
+        if (length == 0) {
+            length = 1;
+            cp = 0;
+        }
+        i += length;
+
+        bool is_letter = cp != 0 && script_of(cp) == script;
+        if (is_letter) {
+            if (!in_word) {
+                prev2 = 0;
+                prev1 = SPACE;
+                in_word = true;
+            }
+            push(to_lower(cp));
+        } else if (in_word) {
+            push(SPACE);
+            in_word = false;
+        }
+    }
+
+    if (in_word) {
+        push(SPACE);
+    }
+}
+
+static ScriptModel build_model(Script script, const std::vector<const LanguageSample*>& samples) {
+    ScriptModel model;
+    model.script = script;
+
+    std::vector<std::unordered_map<uint64_t, uint32_t>> counts(samples.size());
+    std::vector<double> totals(samples.size(), 0.0);
+
+    for (size_t lang = 0; lang < samples.size(); ++lang) {
+        model.codes.push_back(samples[lang]->code);
+        for_each_ngram(samples[lang]->text, script, [&](uint64_t key) {
+            ++counts[lang][key];
+        });
+
+        std::string letters = samples[lang]->alphabet;
+        std::vector<uint32_t> alphabet;
+        size_t i = 0;
+        while (i < letters.size()) {
+            uint32_t cp = 0;
+            size_t length = decode_utf8(letters, i, cp);
+            if (length == 0) {
+                break;
+            }
+            i += length;
+            alphabet.push_back(to_lower(cp));
+        }
+        std::sort(alphabet.begin(), alphabet.end());
+        model.alphabets.push_back(std::move(alphabet));
+    }
+
+    // Keep each language's most frequent n-grams
+    for (size_t lang = 0; lang < samples.size(); ++lang) {
+        std::vector<std::pair<uint64_t, uint32_t>> ranked(counts[lang].begin(), counts[lang].end());
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        if (ranked.size() > PROFILE_SIZE) {
+            ranked.resize(PROFILE_SIZE);
+        }
+
+        counts[lang].clear();
+        for (const auto& [key, count] : ranked) {
+            counts[lang][key] = count;
+            totals[lang] += count;
+            model.keys.push_back(key);
+        }
+    }
+
+    std::sort(model.keys.begin(), model.keys.end());
+    model.keys.erase(std::unique(model.keys.begin(), model.keys.end()), model.keys.end());
+
+    // Add-one smoothing over the shared vocabulary
+    const double vocabulary = static_cast<double>(model.keys.size());
+    const size_t languages = samples.size();
+    model.log_probs.resize(model.keys.size() * languages);
+
+    for (size_t k = 0; k < model.keys.size(); ++k) {
+        for (size_t lang = 0; lang < languages; ++lang) {
+            auto it = counts[lang].find(model.keys[k]);
+            double count = it != counts[lang].end() ? it->second : 0.0;
+            model.log_probs[k * languages + lang] =
+                static_cast<float>(std::log((count + 1.0) / (totals[lang] + vocabulary)));
+        }
+    }
+
+    return model;
+}
+
+static const std::vector<ScriptModel>& script_models() {
+    static const std::vector<ScriptModel> models = [] {
+        std::vector<ScriptModel> result;
+        for (Script script : {Script::Latin, Script::Cyrillic}) {
+            std::vector<const LanguageSample*> samples;
+            for (size_t i = 0; i < LANGUAGE_SAMPLE_COUNT; ++i) {
+                if (scan_text(LANGUAGE_SAMPLES[i].text).dominant_script() == script) {
+                    samples.push_back(&LANGUAGE_SAMPLES[i]);
+                }
+            }
+            result.push_back(build_model(script, samples));
+        }
+        return result;
+    }();
+    return models;
+}
+
+static LanguageGuess score_with_model(const ScriptModel& model, const std::string& text) {
+    const size_t languages = model.codes.size();
+    std::vector<float> scores(languages, 0.0f);
+    size_t matched = 0;
+    std::vector<uint32_t> letters;
+
+    for_each_ngram(text, model.script, [&](uint64_t key) {
+        if (key < UNIGRAM_LIMIT) {
+            letters.push_back(static_cast<uint32_t>(key));
+        }
+        auto it = std::lower_bound(model.keys.begin(), model.keys.end(), key);
+        if (it == model.keys.end() || *it != key) {
+            return;
+        }
+        const float* row = &model.log_probs[(it - model.keys.begin()) * languages];
+        for (size_t lang = 0; lang < languages; ++lang) {
+            scores[lang] += row[lang];
+        }
+        ++matched;
+    });
+
+    LanguageGuess guess;
+    if (matched == 0) {
+        return guess;
+    }
+
+    size_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+    double total = 0.0;
+    for (float score : scores) {
+        total += std::exp((score - scores[best]) / SCORE_TEMPERATURE);
+    }
+
+    // A letter the best match does not use (Serbian "ј" against Russian,
+    // Icelandic "ð" against Danish) means the text is in some language the model
+    // was not trained on, which it would still confidently map onto its
+    // nearest trained neighbour
+    const std::vector<uint32_t>& alphabet = model.alphabets[best];
+    for (uint32_t letter : letters) {
+        if (!std::binary_search(alphabet.begin(), alphabet.end(), letter)) {
+            return guess;
+        }
+    }
+
+    guess.code = model.codes[best];
+    guess.confidence = static_cast<float>(1.0 / total);
+    return guess;
+}
+
+LanguageGuess detect_language_local(const TextScan& scan) {
+    LanguageGuess guess;
+
+    uint32_t letters = scan.letters();
+    if (letters < MIN_LETTERS) {
+        return guess;
+    }
+
+    Script script = scan.dominant_script();
+    uint32_t script_letters = scan.count(script);
+
+    // Japanese mixes kana with Han characters
+    if ((script == Script::Han || script == Script::Kana) && scan.count(Script::Kana) > 0) {
+        script = Script::Kana;
+        script_letters = scan.count(Script::Kana) + scan.count(Script::Han);
+    }
+
+    float script_share = static_cast<float>(script_letters) / letters;
+    float confidence = script_share;
+
+    switch (script) {
+        case Script::Kana:       guess.code = "ja"; break;
+        case Script::Hangul:     guess.code = "ko"; break;
+        case Script::Greek:      guess.code = "el"; break;
+        case Script::Tamil:      guess.code = "ta"; break;
+        case Script::Thai:       guess.code = "th"; break;
+        // Also written in by zh-TW, fa/ur/ps, mr/ne, yi and as respectively
+        case Script::Han:        guess.code = "zh-CN"; confidence = std::min(confidence, SHARED_SCRIPT_CONFIDENCE); break;
+        case Script::Arabic:     guess.code = "ar"; confidence = std::min(confidence, SHARED_SCRIPT_CONFIDENCE); break;
+        case Script::Devanagari: guess.code = "hi"; confidence = std::min(confidence, SHARED_SCRIPT_CONFIDENCE); break;
+        case Script::Hebrew:     guess.code = "iw"; confidence = std::min(confidence, SHARED_SCRIPT_CONFIDENCE); break;
+        case Script::Bengali:    guess.code = "bn"; confidence = std::min(confidence, SHARED_SCRIPT_CONFIDENCE); break;
+        case Script::Latin:
+        case Script::Cyrillic:
+            for (const auto& model : script_models()) {
+                if (model.script == script) {
+                    guess = score_with_model(model, scan.cleaned);
+                    break;
+                }
+            }
+            guess.confidence *= script_share;
+            return guess;
+        default:
+            return guess;
+    }
+
+    guess.confidence = confidence;
+    return guess;
+}
+
+std::string script_language(const TextScan& scan) {
+    uint32_t letters = scan.letters();
+    if (letters == 0) {
+        return "";
+    }
+
+    // Japanese mixes kana with Han characters
+    if (scan.count(Script::Kana) > 0 && scan.count(Script::Kana) + scan.count(Script::Han) == letters) {
+        return "ja";
+    }
+
+    Script script = scan.dominant_script();
+    if (scan.count(script) != letters) {
+        return "";
+    }
+    // Hebrew (iw, yi) and Bengali (bn, as) are shared, like Latin or Arabic
+    switch (script) {
+        case Script::Hangul:  return "ko";
+        case Script::Greek:   return "el";
+        case Script::Tamil:   return "ta";
+        case Script::Thai:    return "th";
+        default:              return "";
+    }
+}
+
+LanguageGuess detect_language_local(const std::string& text) {
+    return detect_language_local(scan_text(text));
+}
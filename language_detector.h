@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "text_scanner.h"
+
+// Labeled training text used to build the n-gram profiles
+struct LanguageSample {
+    const char* code;
+    const char* alphabet;  // Every lowercase letter of the language
+    const char* text;
+};
+
+extern const LanguageSample LANGUAGE_SAMPLES[];
+extern const size_t LANGUAGE_SAMPLE_COUNT;
+
+struct LanguageGuess {
+    std::string code;        // Empty when the text gives nothing to go on
+    float confidence = 0.0f; // 0..1
+};
+
+// In-process language identification. Languages with a script of their own
+// are decided by script alone; Latin and Cyrillic text is scored against
+// character 1-3 gram profiles with a naive Bayes model. Text that may be in
+// a supported language the models were not trained on (shared scripts,
+// letters outside the trained alphabets) gets no or low confidence answers.
+LanguageGuess detect_language_local(const TextScan& scan);
+LanguageGuess detect_language_local(const std::string& text);
+
+// Language of text whose letters are all in a script that, among the
+// supported languages, only it uses (kana, Hangul, Greek, Tamil, Thai).
+// "" for anything else.
+std::string script_language(const TextScan& scan);
@@ -0,0 +1,506 @@
+#include "language_detector.h"
+
+// Training text for the character n-gram profiles, each with its full
+// alphabet since the text need not use every letter. Languages written in a
+// script no model covers (Greek, Hebrew, Thai, Hangul, ...) are identified by
+// script alone and need no sample here.
+const LanguageSample LANGUAGE_SAMPLES[] = {
+    {"en", "abcdefghijklmnopqrstuvwxyzé", R"(
+Hello everyone, how are you doing today? I think we should start the game now because it is getting late.
+Thanks for the help, I really appreciate it. Does anyone know when the next update is coming out?
+The weather was nice this morning so we went for a walk in the park with the dog.
+I don't know what happened, my computer just stopped working and now I have to restart everything.
+Can you send me the link again? I could not find it in the channel.
+We are going to the store later, do you want anything? Please let me know before we leave.
+This is the best song I have heard all week, you should listen to it when you have time.
+Good morning! Did you sleep well? I was up all night finishing my homework for school.
+They said the meeting was moved to Thursday afternoon, so there is no need to come in tomorrow.
+What time does the stream start? I want to watch it with my friends after dinner.
+It would be great if we could play together this weekend, just tell me which day works for you.
+I have been learning how to cook and yesterday I made pasta with tomato sauce for the whole family.
+The new movie was much better than I expected, although the ending was a little strange.
+Where is everybody? The server has been really quiet since the holidays started.
+)"},
+    {"es", "abcdefghijklmnopqrstuvwxyzáéíñóúü", R"(
+Hola a todos, ¿cómo están hoy? Creo que deberíamos empezar la partida ahora porque ya es tarde.
+Gracias por la ayuda, de verdad lo aprecio mucho. ¿Alguien sabe cuándo sale la próxima actualización?
+El tiempo estaba muy bueno esta mañana así que fuimos a caminar al parque con el perro.
+No sé qué pasó, mi ordenador dejó de funcionar y ahora tengo que reiniciar todo otra vez.
+¿Me puedes mandar el enlace otra vez? No lo encontré en el canal.
+Vamos a ir a la tienda más tarde, ¿quieres algo? Avísame antes de que salgamos.
+Esta es la mejor canción que he escuchado en toda la semana, deberías escucharla cuando tengas tiempo.
+¡Buenos días! ¿Dormiste bien? Estuve despierto toda la noche terminando los deberes del colegio.
+Dijeron que la reunión se cambió al jueves por la tarde, así que no hace falta venir mañana.
+¿A qué hora empieza el directo? Quiero verlo con mis amigos después de cenar.
+Sería genial si pudiéramos jugar juntos este fin de semana, solo dime qué día te viene bien.
+He estado aprendiendo a cocinar y ayer hice pasta con salsa de tomate para toda la familia.
+La nueva película fue mucho mejor de lo que esperaba, aunque el final fue un poco raro.
+¿Dónde está todo el mundo? El servidor ha estado muy tranquilo desde que empezaron las vacaciones.
+)"},
+    {"fr", "abcdefghijklmnopqrstuvwxyzàâæçéèêëîïôœùûüÿ", R"(
+Salut tout le monde, comment ça va aujourd'hui ? Je pense qu'on devrait commencer la partie maintenant parce qu'il est déjà tard.
+Merci pour l'aide, je l'apprécie vraiment beaucoup. Est-ce que quelqu'un sait quand la prochaine mise à jour va sortir ?
+Il faisait très beau ce matin alors nous sommes allés nous promener au parc avec le chien.
+Je ne sais pas ce qui s'est passé, mon ordinateur a arrêté de fonctionner et maintenant je dois tout redémarrer.
+Tu peux m'envoyer le lien encore une fois ? Je ne l'ai pas trouvé dans le salon.
+On va aller au magasin plus tard, tu veux quelque chose ? Dis-le-moi avant que nous partions.
+C'est la meilleure chanson que j'ai entendue de toute la semaine, tu devrais l'écouter quand tu as le temps.
+Bonjour ! Tu as bien dormi ? J'ai passé toute la nuit à finir mes devoirs pour l'école.
+Ils ont dit que la réunion a été déplacée à jeudi après-midi, donc ce n'est pas la peine de venir demain.
+À quelle heure commence le live ? Je veux le regarder avec mes amis après le dîner.
+Ce serait génial si on pouvait jouer ensemble ce week-end, dis-moi juste quel jour te convient.
+J'apprends à cuisiner et hier j'ai fait des pâtes à la sauce tomate pour toute la famille.
+Le nouveau film était bien meilleur que ce que j'attendais, même si la fin était un peu bizarre.
+Où est tout le monde ? Le serveur est vraiment calme depuis le début des vacances.
+)"},
+    {"de", "abcdefghijklmnopqrstuvwxyzäöüß", R"(
+Hallo zusammen, wie geht es euch heute? Ich glaube, wir sollten jetzt mit dem Spiel anfangen, weil es schon spät ist.
+Danke für die Hilfe, das weiß ich wirklich zu schätzen. Weiß jemand, wann das nächste Update herauskommt?
+Das Wetter war heute Morgen sehr schön, also sind wir mit dem Hund im Park spazieren gegangen.
+Ich weiß nicht, was passiert ist, mein Computer hat einfach aufgehört zu funktionieren und jetzt muss ich alles neu starten.
+Kannst du mir den Link noch einmal schicken? Ich konnte ihn im Kanal nicht finden.
+Wir gehen später noch einkaufen, möchtest du etwas? Sag mir bitte Bescheid, bevor wir losfahren.
+Das ist das beste Lied, das ich die ganze Woche gehört habe, du solltest es dir anhören, wenn du Zeit hast.
+Guten Morgen! Hast du gut geschlafen? Ich war die ganze Nacht wach und habe meine Hausaufgaben für die Schule gemacht.
+Sie haben gesagt, dass das Treffen auf Donnerstagnachmittag verschoben wurde, also musst du morgen nicht kommen.
+Um wie viel Uhr fängt der Stream an? Ich möchte ihn nach dem Abendessen mit meinen Freunden anschauen.
+Es wäre toll, wenn wir am Wochenende zusammen spielen könnten, sag mir einfach, welcher Tag dir passt.
+Ich lerne gerade kochen und gestern habe ich Nudeln mit Tomatensoße für die ganze Familie gemacht.
+Der neue Film war viel besser als erwartet, obwohl das Ende ein bisschen seltsam war.
+Wo sind denn alle? Auf dem Server ist es ziemlich ruhig, seit die Ferien angefangen haben.
+)"},
+    {"it", "abcdefghijklmnopqrstuvwxyzàèéìíîòóùú", R"(
+Ciao a tutti, come state oggi? Penso che dovremmo iniziare la partita adesso perché si sta facendo tardi.
+Grazie per l'aiuto, lo apprezzo davvero tanto. Qualcuno sa quando uscirà il prossimo aggiornamento?
+Il tempo era molto bello stamattina quindi siamo andati a fare una passeggiata al parco con il cane.
+Non so cosa sia successo, il mio computer ha smesso di funzionare e adesso devo riavviare tutto.
+Puoi mandarmi di nuovo il link? Non sono riuscito a trovarlo nel canale.
+Più tardi andiamo al negozio, vuoi qualcosa? Fammi sapere prima che usciamo.
+Questa è la canzone più bella che ho sentito in tutta la settimana, dovresti ascoltarla quando hai tempo.
+Buongiorno! Hai dormito bene? Sono stato sveglio tutta la notte per finire i compiti per la scuola.
+Hanno detto che la riunione è stata spostata a giovedì pomeriggio, quindi non c'è bisogno di venire domani.
+A che ora inizia la diretta? Voglio guardarla con i miei amici dopo cena.
+Sarebbe fantastico se potessimo giocare insieme questo fine settimana, dimmi solo quale giorno ti va bene.
+Sto imparando a cucinare e ieri ho fatto la pasta al sugo di pomodoro per tutta la famiglia.
+Il nuovo film è stato molto meglio di quanto mi aspettassi, anche se il finale era un po' strano.
+Dove sono tutti? Il server è stato davvero tranquillo da quando sono iniziate le vacanze.
+)"},
+    {"pt", "abcdefghijklmnopqrstuvwxyzáâãàçéêíóôõú", R"(
+Olá a todos, como vocês estão hoje? Acho que devíamos começar o jogo agora porque já está ficando tarde.
+Obrigado pela ajuda, eu realmente agradeço muito. Alguém sabe quando vai sair a próxima atualização?
+O tempo estava muito bom hoje de manhã então fomos passear no parque com o cachorro.
+Não sei o que aconteceu, o meu computador simplesmente parou de funcionar e agora tenho que reiniciar tudo.
+Você pode me mandar o link de novo? Não consegui encontrar no canal.
+Nós vamos à loja mais tarde, você quer alguma coisa? Me avisa antes de a gente sair.
+Essa é a melhor música que eu ouvi a semana toda, você devia escutar quando tiver tempo.
+Bom dia! Dormiu bem? Eu fiquei acordado a noite inteira terminando a lição de casa da escola.
+Eles disseram que a reunião foi mudada para quinta-feira à tarde, então não precisa vir amanhã.
+Que horas começa a transmissão? Quero assistir com os meus amigos depois do jantar.
+Seria ótimo se a gente pudesse jogar junto neste fim de semana, é só me dizer qual dia fica melhor para você.
+Estou aprendendo a cozinhar e ontem fiz macarrão com molho de tomate para a família inteira.
+O filme novo foi muito melhor do que eu esperava, embora o final tenha sido um pouco estranho.
+Cadê todo mundo? O servidor está muito parado desde que as férias começaram.
+)"},
+    {"nl", "abcdefghijklmnopqrstuvwxyzáéíóúàèëïöü", R"(
+Hallo allemaal, hoe gaat het vandaag met jullie? Ik denk dat we nu met het spel moeten beginnen, want het wordt al laat.
+Bedankt voor de hulp, ik waardeer het echt heel erg. Weet iemand wanneer de volgende update uitkomt?
+Het weer was vanochtend heel mooi, dus zijn we met de hond in het park gaan wandelen.
+Ik weet niet wat er gebeurd is, mijn computer deed het ineens niet meer en nu moet ik alles opnieuw opstarten.
+Kun je me de link nog een keer sturen? Ik kon hem niet vinden in het kanaal.
+We gaan straks naar de winkel, wil je nog iets hebben? Laat het me weten voordat we vertrekken.
+Dit is het beste nummer dat ik de hele week heb gehoord, je moet het eens luisteren als je tijd hebt.
+Goedemorgen! Heb je goed geslapen? Ik ben de hele nacht wakker gebleven om mijn huiswerk voor school af te maken.
+Ze zeiden dat de vergadering is verplaatst naar donderdagmiddag, dus je hoeft morgen niet te komen.
+Hoe laat begint de stream? Ik wil hem na het eten met mijn vrienden kijken.
+Het zou leuk zijn als we dit weekend samen kunnen spelen, zeg maar welke dag jou uitkomt.
+Ik ben aan het leren koken en gisteren heb ik pasta met tomatensaus gemaakt voor het hele gezin.
+De nieuwe film was veel beter dan ik had verwacht, al was het einde een beetje vreemd.
+Waar is iedereen? Het is echt stil op de server sinds de vakantie begonnen is.
+)"},
+    {"pl", "abcdefghijklmnopqrstuvwxyząćęłńóśźż", R"(
+Cześć wszystkim, jak się dzisiaj macie? Myślę, że powinniśmy teraz zacząć grę, bo robi się już późno.
+Dzięki za pomoc, naprawdę to doceniam. Czy ktoś wie, kiedy wyjdzie następna aktualizacja?
+Pogoda była dziś rano bardzo ładna, więc poszliśmy z psem na spacer do parku.
+Nie wiem, co się stało, mój komputer po prostu przestał działać i teraz muszę wszystko uruchomić od nowa.
+Możesz mi jeszcze raz wysłać link? Nie mogłem go znaleźć na kanale.
+Idziemy później do sklepu, chcesz coś? Daj mi znać, zanim wyjdziemy.
+To najlepsza piosenka, jaką słyszałem w tym tygodniu, powinieneś jej posłuchać, kiedy będziesz miał czas.
+Dzień dobry! Dobrze spałeś? Nie spałem całą noc, bo kończyłem pracę domową do szkoły.
+Powiedzieli, że spotkanie zostało przeniesione na czwartek po południu, więc nie musisz jutro przychodzić.
+O której zaczyna się transmisja? Chcę ją obejrzeć z przyjaciółmi po kolacji.
+Byłoby super, gdybyśmy mogli zagrać razem w ten weekend, powiedz mi tylko, który dzień ci pasuje.
+Uczę się gotować i wczoraj zrobiłem makaron z sosem pomidorowym dla całej rodziny.
+Nowy film był dużo lepszy, niż się spodziewałem, chociaż zakończenie było trochę dziwne.
+Gdzie są wszyscy? Na serwerze jest naprawdę cicho, odkąd zaczęły się wakacje.
+)"},
+    {"tr", "abcdefghijklmnopqrstuvwxyzâçğıîöşûü", R"(
+Herkese merhaba, bugün nasılsınız? Bence oyuna şimdi başlamalıyız çünkü saat geç oluyor.
+Yardımın için teşekkürler, gerçekten çok minnettarım. Bir sonraki güncellemenin ne zaman çıkacağını bilen var mı?
+Bu sabah hava çok güzeldi, bu yüzden köpekle parkta yürüyüşe çıktık.
+Ne olduğunu bilmiyorum, bilgisayarım birden çalışmayı bıraktı ve şimdi her şeyi yeniden başlatmam gerekiyor.
+Bağlantıyı bana tekrar gönderebilir misin? Kanalda bulamadım.
+Daha sonra markete gideceğiz, bir şey ister misin? Çıkmadan önce bana haber ver lütfen.
+Bu hafta duyduğum en güzel şarkı bu, vaktin olduğunda mutlaka dinlemelisin.
+Günaydın! İyi uyudun mu? Okul ödevlerimi bitirmek için bütün gece uyanıktım.
+Toplantının perşembe öğleden sonraya ertelendiğini söylediler, yani yarın gelmene gerek yok.
+Yayın saat kaçta başlıyor? Akşam yemeğinden sonra arkadaşlarımla izlemek istiyorum.
+Bu hafta sonu birlikte oynayabilsek harika olur, sadece hangi günün sana uygun olduğunu söyle.
+Yemek yapmayı öğreniyorum ve dün bütün aile için domates soslu makarna yaptım.
+Yeni film beklediğimden çok daha iyiydi, ama sonu biraz garipti.
+Herkes nerede? Tatil başladığından beri sunucu gerçekten çok sessiz.
+)"},
+    {"vi", "abcdefghijklmnopqrstuvwxyzđàáảãạăằắẳẵặâầấẩẫậèéẻẽẹêềếểễệìíỉĩịòóỏõọôồốổỗộơờớởỡợùúủũụưừứửữựỳýỷỹỵ", R"(
+Xin chào mọi người, hôm nay các bạn thế nào? Mình nghĩ chúng ta nên bắt đầu trận đấu ngay bây giờ vì đã muộn rồi.
+Cảm ơn bạn đã giúp đỡ, mình thật sự rất biết ơn. Có ai biết khi nào bản cập nhật tiếp theo sẽ ra không?
+Sáng nay thời tiết rất đẹp nên chúng tôi đã đi dạo trong công viên với con chó.
+Mình không biết chuyện gì đã xảy ra, máy tính của mình tự nhiên ngừng hoạt động và bây giờ phải khởi động lại tất cả.
+Bạn có thể gửi lại đường link cho mình được không? Mình không tìm thấy nó trong kênh.
+Lát nữa chúng mình sẽ đi cửa hàng, bạn có muốn mua gì không? Hãy báo cho mình biết trước khi đi nhé.
+Đây là bài hát hay nhất mà mình nghe trong cả tuần, bạn nên nghe thử khi có thời gian.
+Chào buổi sáng! Bạn ngủ có ngon không? Mình đã thức cả đêm để làm xong bài tập về nhà.
+Họ nói cuộc họp đã được dời sang chiều thứ năm, vì vậy ngày mai bạn không cần phải đến.
+Mấy giờ thì buổi phát trực tiếp bắt đầu? Mình muốn xem cùng bạn bè sau bữa tối.
+Sẽ thật tuyệt nếu cuối tuần này chúng ta có thể chơi cùng nhau, chỉ cần nói cho mình biết ngày nào bạn rảnh.
+Mình đang học nấu ăn và hôm qua đã làm mì ống sốt cà chua cho cả gia đình.
+Bộ phim mới hay hơn nhiều so với mình mong đợi, mặc dù cái kết hơi kỳ lạ.
+Mọi người đâu hết rồi? Máy chủ rất yên tĩnh từ khi kỳ nghỉ bắt đầu.
+)"},
+    {"sv", "abcdefghijklmnopqrstuvwxyzåäöé", R"(
+Hej allihopa, hur mår ni idag? Jag tycker att vi borde börja spelet nu eftersom det börjar bli sent.
+Tack för hjälpen, jag uppskattar det verkligen. Vet någon när nästa uppdatering kommer ut?
+Vädret var jättefint i morse så vi gick en promenad i parken med hunden.
+Jag vet inte vad som hände, min dator slutade bara fungera och nu måste jag starta om allting.
+Kan du skicka länken till mig igen? Jag kunde inte hitta den i kanalen.
+Vi ska gå till affären senare, vill du ha något? Säg till innan vi åker.
+Det här är den bästa låten jag har hört på hela veckan, du borde lyssna på den när du har tid.
+God morgon! Sov du gott? Jag var vaken hela natten och gjorde klart mina läxor till skolan.
+De sa att mötet har flyttats till torsdag eftermiddag, så du behöver inte komma i morgon.
+Vilken tid börjar sändningen? Jag vill titta på den med mina kompisar efter middagen.
+Det vore kul om vi kunde spela tillsammans i helgen, säg bara vilken dag som passar dig.
+Jag håller på att lära mig laga mat och igår gjorde jag pasta med tomatsås till hela familjen.
+Den nya filmen var mycket bättre än jag hade trott, även om slutet var lite konstigt.
+Var är alla? Det har varit väldigt tyst på servern sedan lovet började.
+)"},
+    {"no", "abcdefghijklmnopqrstuvwxyzæøåéèêóòâô", R"(
+Hei alle sammen, hvordan har dere det i dag? Jeg synes vi burde starte spillet nå fordi det begynner å bli sent.
+Takk for hjelpen, jeg setter virkelig pris på det. Er det noen som vet når neste oppdatering kommer ut?
+Været var veldig fint i morges, så vi gikk en tur i parken med hunden.
+Jeg vet ikke hva som skjedde, datamaskinen min sluttet bare å virke og nå må jeg starte alt på nytt.
+Kan du sende meg lenken en gang til? Jeg fant den ikke i kanalen.
+Vi skal på butikken senere, vil du ha noe? Si ifra før vi drar.
+Dette er den beste sangen jeg har hørt hele uka, du burde høre på den når du har tid.
+God morgen! Sov du godt? Jeg var våken hele natta og gjorde ferdig leksene mine til skolen.
+De sa at møtet er flyttet til torsdag ettermiddag, så du trenger ikke å komme i morgen.
+Når begynner strømmen? Jeg vil se på den sammen med vennene mine etter middag.
+Det hadde vært gøy om vi kunne spille sammen i helga, bare si hvilken dag som passer for deg.
+Jeg holder på å lære meg å lage mat, og i går laget jeg pasta med tomatsaus til hele familien.
+Den nye filmen var mye bedre enn jeg hadde trodd, selv om slutten var litt rar.
+Hvor er alle sammen? Det har vært veldig stille på serveren siden ferien begynte.
+)"},
+    {"da", "abcdefghijklmnopqrstuvwxyzæøåé", R"(
+Hej allesammen, hvordan har I det i dag? Jeg synes, vi skulle starte spillet nu, fordi det er ved at blive sent.
+Tak for hjælpen, det sætter jeg virkelig pris på. Er der nogen, der ved, hvornår den næste opdatering kommer?
+Vejret var rigtig dejligt i morges, så vi gik en tur i parken med hunden.
+Jeg ved ikke, hvad der skete, min computer holdt bare op med at virke, og nu skal jeg genstarte det hele.
+Kan du sende mig linket igen? Jeg kunne ikke finde det i kanalen.
+Vi skal ned i butikken senere, vil du have noget? Sig til, før vi tager af sted.
+Det her er den bedste sang, jeg har hørt hele ugen, du burde lytte til den, når du har tid.
+Godmorgen! Har du sovet godt? Jeg var vågen hele natten og lavede mine lektier færdige til skolen.
+De sagde, at mødet er blevet flyttet til torsdag eftermiddag, så du behøver ikke at komme i morgen.
+Hvornår starter streamen? Jeg vil gerne se den sammen med mine venner efter aftensmaden.
+Det ville være fedt, hvis vi kunne spille sammen i weekenden, bare sig hvilken dag der passer dig.
+Jeg er ved at lære at lave mad, og i går lavede jeg pasta med tomatsovs til hele familien.
+Den nye film var meget bedre, end jeg havde forventet, selvom slutningen var lidt mærkelig.
+Hvor er alle henne? Der har været virkelig stille på serveren, siden ferien begyndte.
+)"},
+    {"fi", "abcdefghijklmnopqrstuvwxyzåäöšž", R"(
+Hei kaikki, mitä teille kuuluu tänään? Minusta meidän pitäisi aloittaa peli nyt, koska on jo myöhä.
+Kiitos avusta, arvostan sitä todella paljon. Tietääkö kukaan, milloin seuraava päivitys julkaistaan?
+Sää oli tänä aamuna todella kaunis, joten kävimme kävelyllä puistossa koiran kanssa.
+En tiedä mitä tapahtui, tietokoneeni lakkasi vain toimimasta ja nyt minun täytyy käynnistää kaikki uudelleen.
+Voitko lähettää linkin minulle uudestaan? En löytänyt sitä kanavalta.
+Menemme myöhemmin kauppaan, haluatko jotain? Kerro minulle ennen kuin lähdemme.
+Tämä on paras kappale, jonka olen kuullut koko viikolla, sinun kannattaa kuunnella se kun sinulla on aikaa.
+Huomenta! Nukuitko hyvin? Olin hereillä koko yön ja tein koulun kotitehtävät valmiiksi.
+He sanoivat, että kokous on siirretty torstai-iltapäivään, joten sinun ei tarvitse tulla huomenna.
+Mihin aikaan lähetys alkaa? Haluan katsoa sen ystävieni kanssa päivällisen jälkeen.
+Olisi mahtavaa, jos voisimme pelata yhdessä tänä viikonloppuna, kerro vain mikä päivä sopii sinulle.
+Olen opetellut kokkaamaan ja eilen tein koko perheelle pastaa tomaattikastikkeella.
+Uusi elokuva oli paljon parempi kuin odotin, vaikka loppu olikin vähän outo.
+Missä kaikki ovat? Palvelimella on ollut todella hiljaista lomien alkamisen jälkeen.
+)"},
+    {"cs", "abcdefghijklmnopqrstuvwxyzáčďéěíňóřšťúůýž", R"(
+Ahoj všichni, jak se dnes máte? Myslím, že bychom měli začít hru hned teď, protože už je pozdě.
+Díky za pomoc, opravdu si toho vážím. Neví někdo, kdy vyjde další aktualizace?
+Dnes ráno bylo moc hezky, tak jsme šli se psem na procházku do parku.
+Nevím, co se stalo, můj počítač prostě přestal fungovat a teď musím všechno restartovat.
+Můžeš mi ten odkaz poslat ještě jednou? Nemohl jsem ho v kanálu najít.
+Později půjdeme do obchodu, chceš něco? Dej mi vědět, než odejdeme.
+Tohle je nejlepší písnička, kterou jsem celý týden slyšel, měl by sis ji poslechnout, až budeš mít čas.
+Dobré ráno! Vyspal ses dobře? Byl jsem vzhůru celou noc a dodělával jsem úkoly do školy.
+Říkali, že schůzka byla přesunuta na čtvrtek odpoledne, takže zítra nemusíš chodit.
+V kolik začíná stream? Chci se na něj podívat s kamarády po večeři.
+Bylo by skvělé, kdybychom mohli tento víkend hrát spolu, jen mi řekni, který den se ti hodí.
+Učím se vařit a včera jsem udělal těstoviny s rajčatovou omáčkou pro celou rodinu.
+Nový film byl mnohem lepší, než jsem čekal, i když konec byl trochu divný.
+Kde jsou všichni? Na serveru je opravdu ticho od té doby, co začaly prázdniny.
+)"},
+    {"ro", "abcdefghijklmnopqrstuvwxyzăâîșțşţ", R"(
+Salut tuturor, ce mai faceți astăzi? Cred că ar trebui să începem jocul acum pentru că se face târziu.
+Mulțumesc pentru ajutor, chiar apreciez foarte mult. Știe cineva când iese următoarea actualizare?
+Vremea a fost foarte frumoasă azi dimineață așa că am ieșit la plimbare în parc cu câinele.
+Nu știu ce s-a întâmplat, calculatorul meu pur și simplu nu mai funcționează și acum trebuie să repornesc totul.
+Poți să-mi trimiți linkul din nou? Nu l-am găsit pe canal.
+Mergem mai târziu la magazin, vrei ceva? Anunță-mă înainte să plecăm.
+Aceasta este cea mai bună melodie pe care am auzit-o toată săptămâna, ar trebui s-o asculți când ai timp.
+Bună dimineața! Ai dormit bine? Am stat treaz toată noaptea ca să-mi termin temele pentru școală.
+Au spus că întâlnirea a fost mutată joi după-amiază, deci nu e nevoie să vii mâine.
+La ce oră începe transmisiunea? Vreau s-o urmăresc cu prietenii mei după cină.
+Ar fi grozav dacă am putea juca împreună în weekendul acesta, spune-mi doar ce zi îți convine.
+Învăț să gătesc și ieri am făcut paste cu sos de roșii pentru toată familia.
+Filmul cel nou a fost mult mai bun decât mă așteptam, deși finalul a fost puțin ciudat.
+Unde este toată lumea? Serverul a fost foarte liniștit de când a început vacanța.
+)"},
+    {"hu", "abcdefghijklmnopqrstuvwxyzáéíóöőúüű", R"(
+Sziasztok, hogy vagytok ma? Szerintem most kellene elkezdenünk a játékot, mert már késő van.
+Köszönöm a segítséget, nagyon hálás vagyok érte. Tudja valaki, hogy mikor jön ki a következő frissítés?
+Ma reggel nagyon szép idő volt, ezért elmentünk sétálni a parkba a kutyával.
+Nem tudom, mi történt, a számítógépem egyszerűen leállt, és most mindent újra kell indítanom.
+El tudnád küldeni még egyszer a linket? Nem találtam meg a csatornában.
+Később elmegyünk a boltba, kérsz valamit? Szólj, mielőtt elindulunk.
+Ez a legjobb dal, amit egész héten hallottam, hallgasd meg, ha lesz időd.
+Jó reggelt! Jól aludtál? Egész éjjel fent voltam, hogy befejezzem az iskolai házi feladatomat.
+Azt mondták, hogy a megbeszélést áttették csütörtök délutánra, úgyhogy holnap nem kell bejönnöd.
+Hány órakor kezdődik az adás? Vacsora után szeretném megnézni a barátaimmal.
+Nagyon jó lenne, ha hétvégén együtt játszhatnánk, csak mondd meg, melyik nap jó neked.
+Most tanulok főzni, és tegnap paradicsomszószos tésztát csináltam az egész családnak.
+Az új film sokkal jobb volt, mint amire számítottam, bár a vége egy kicsit furcsa volt.
+Hol van mindenki? Nagyon csendes a szerver, amióta elkezdődött a szünet.
+)"},
+    {"id", "abcdefghijklmnopqrstuvwxyzé", R"(
+Halo semuanya, apa kabar hari ini? Menurut saya kita harus mulai permainannya sekarang karena sudah mulai malam.
+Terima kasih atas bantuannya, saya sangat menghargainya. Apakah ada yang tahu kapan pembaruan berikutnya akan keluar?
+Cuaca pagi ini sangat cerah jadi kami pergi jalan-jalan ke taman bersama anjing.
+Saya tidak tahu apa yang terjadi, komputer saya tiba-tiba berhenti bekerja dan sekarang saya harus menyalakan ulang semuanya.
+Bisakah kamu mengirimkan tautannya lagi? Saya tidak bisa menemukannya di kanal.
+Nanti kami akan pergi ke toko, kamu mau titip sesuatu? Kabari saya sebelum kami berangkat ya.
+Ini lagu terbaik yang saya dengar minggu ini, kamu harus mendengarkannya kalau ada waktu.
+Selamat pagi! Tidurmu nyenyak? Saya begadang semalaman untuk menyelesaikan pekerjaan rumah dari sekolah.
+Mereka bilang rapatnya dipindah ke hari Kamis sore, jadi kamu tidak perlu datang besok.
+Jam berapa siaran langsungnya dimulai? Saya mau menontonnya bersama teman-teman setelah makan malam.
+Akan sangat seru kalau kita bisa bermain bersama akhir pekan ini, bilang saja hari apa yang cocok untukmu.
+Saya sedang belajar memasak dan kemarin saya membuat pasta dengan saus tomat untuk seluruh keluarga.
+Film barunya jauh lebih bagus dari yang saya harapkan, walaupun akhirnya agak aneh.
+Semua orang ke mana? Servernya sepi sekali sejak liburan dimulai.
+)"},
+    {"ms", "abcdefghijklmnopqrstuvwxyz", R"(
+Hai semua, apa khabar hari ini? Saya rasa kita patut mulakan permainan sekarang kerana hari sudah lewat.
+Terima kasih atas bantuan anda, saya amat menghargainya. Ada sesiapa tahu bila kemas kini seterusnya akan dikeluarkan?
+Cuaca pagi tadi sangat baik jadi kami pergi bersiar-siar di taman dengan anjing.
+Saya tak tahu apa yang berlaku, komputer saya tiba-tiba berhenti berfungsi dan sekarang saya perlu mulakan semula semuanya.
+Boleh awak hantar pautan itu sekali lagi? Saya tak jumpa dalam saluran.
+Kami akan pergi ke kedai nanti, awak nak apa-apa? Beritahu saya sebelum kami bertolak.
+Ini lagu paling best yang saya dengar minggu ini, awak patut dengar bila ada masa.
+Selamat pagi! Awak tidur lena? Saya berjaga sepanjang malam untuk siapkan kerja rumah sekolah.
+Mereka kata mesyuarat itu telah dipindahkan ke petang Khamis, jadi awak tak perlu datang esok.
+Pukul berapa siaran langsung bermula? Saya nak tonton dengan kawan-kawan selepas makan malam.
+Seronok kalau kita boleh main bersama hujung minggu ini, beritahu saja hari mana yang sesuai untuk awak.
+Saya sedang belajar memasak dan semalam saya buat pasta dengan sos tomato untuk seluruh keluarga.
+Filem baharu itu jauh lebih bagus daripada yang saya jangkakan, walaupun pengakhirannya agak pelik.
+Mana semua orang? Pelayan ini sangat sunyi sejak cuti sekolah bermula.
+)"},
+    {"tl", "abcdefghijklmnopqrstuvwxyzñ", R"(
+Kumusta kayong lahat, kamusta kayo ngayong araw? Sa tingin ko dapat na nating simulan ang laro ngayon kasi gabi na.
+Salamat sa tulong, talagang pinahahalagahan ko ito. May nakakaalam ba kung kailan lalabas ang susunod na update?
+Napakaganda ng panahon kaninang umaga kaya naglakad-lakad kami sa parke kasama ang aso.
+Hindi ko alam kung ano ang nangyari, biglang tumigil sa paggana ang kompyuter ko at ngayon kailangan kong i-restart ang lahat.
+Puwede mo bang ipadala ulit sa akin ang link? Hindi ko ito makita sa channel.
+Pupunta kami sa tindahan mamaya, may gusto ka bang ipabili? Sabihan mo ako bago kami umalis.
+Ito ang pinakamagandang kanta na narinig ko ngayong linggo, dapat mo itong pakinggan kapag may oras ka.
+Magandang umaga! Maayos ba ang tulog mo? Gising ako buong gabi para tapusin ang takdang-aralin ko sa paaralan.
+Sabi nila inilipat ang pulong sa Huwebes ng hapon, kaya hindi mo na kailangang pumunta bukas.
+Anong oras magsisimula ang stream? Gusto kong panoorin ito kasama ang mga kaibigan ko pagkatapos ng hapunan.
+Ang saya siguro kung makakapaglaro tayo nang magkasama ngayong katapusan ng linggo, sabihin mo lang kung anong araw ang puwede ka.
+Nag-aaral akong magluto at kahapon gumawa ako ng pasta na may sarsang kamatis para sa buong pamilya.
+Mas maganda pala ang bagong pelikula kaysa sa inaasahan ko, kahit medyo kakaiba ang katapusan.
+Nasaan na ang lahat? Sobrang tahimik ng server mula nang magsimula ang bakasyon.
+)"},
+    {"ca", "abcdefghijklmnopqrstuvwxyzàçéèíïòóúü", R"(
+Hola a tothom, com esteu avui? Crec que hauríem de començar la partida ara perquè s'està fent tard.
+Gràcies per l'ajuda, de debò que ho agraeixo. Algú sap quan surt la pròxima actualització?
+Aquest matí feia bon temps, així que hem anat a fer un passeig pel parc amb el gos.
+No sé què ha passat, l'ordinador s'ha aturat de cop i ara ho he de reiniciar tot.
+Em pots tornar a enviar l'enllaç? No l'he trobat al canal.
+Després anirem a la botiga, vols alguna cosa? Digues-m'ho abans que marxem.
+És la millor cançó que he sentit en tota la setmana, l'hauries d'escoltar quan tinguis temps.
+Bon dia! Has dormit bé? Jo he estat despert tota la nit acabant els deures de l'escola.
+Van dir que la reunió s'ha canviat a dijous a la tarda, així que demà no cal que vinguis.
+A quina hora comença el directe? El vull veure amb els meus amics després de sopar.
+Estaria molt bé que poguéssim jugar junts aquest cap de setmana, només digues-me quin dia et va bé.
+He estat aprenent a cuinar i ahir vaig fer pasta amb salsa de tomàquet per a tota la família.
+La nova pel·lícula era molt millor del que esperava, tot i que el final era una mica estrany.
+On és tothom? El servidor ha estat molt tranquil des que van començar les vacances.
+)"},
+    {"gl", "abcdefghijklmnopqrstuvwxyzáéíñóúü", R"(
+Ola a todos, que tal estades hoxe? Creo que deberiamos comezar a partida agora porque xa se está facendo tarde.
+Grazas pola axuda, de verdade que o agradezo. Alguén sabe cando sae a próxima actualización?
+O tempo estaba bo esta mañá, así que fomos dar un paseo polo parque co can.
+Non sei que pasou, o meu ordenador deixou de funcionar e agora teño que reinicialo todo.
+Podes mandarme a ligazón outra vez? Non a atopei na canle.
+Imos ir á tenda máis tarde, queres algo? Avísame antes de que saiamos.
+Esta é a mellor canción que escoitei en toda a semana, deberías escoitala cando teñas tempo.
+Bos días! Durmiches ben? Estiven esperto toda a noite rematando os deberes do colexio.
+Dixeron que a reunión se mudou para o xoves pola tarde, así que non fai falla vir mañá.
+A que hora comeza a emisión? Quero vela cos meus amigos despois da cea.
+Sería xenial que puidésemos xogar xuntos esta fin de semana, só dime que día che vai ben.
+Estiven aprendendo a cociñar e onte fixen pasta con salsa de tomate para toda a familia.
+A nova película foi moito mellor do que esperaba, aínda que o final foi un pouco estraño.
+Onde está todo o mundo? O servidor estivo moi tranquilo desde que comezaron as vacacións.
+)"},
+    {"sk", "abcdefghijklmnopqrstuvwxyzáäčďéíĺľňóôŕšťúýž", R"(
+Ahojte všetci, ako sa dnes máte? Myslím, že by sme mali začať hru teraz, lebo už je neskoro.
+Vďaka za pomoc, naozaj si to vážim. Nevie niekto, kedy vyjde ďalšia aktualizácia?
+Ráno bolo pekné počasie, tak sme sa išli prejsť so psom do parku.
+Neviem, čo sa stalo, počítač mi jednoducho prestal fungovať a teraz musím všetko reštartovať.
+Môžeš mi ten odkaz poslať ešte raz? Nemohol som ho nájsť v kanáli.
+Neskôr pôjdeme do obchodu, chceš niečo? Daj mi vedieť, kým odídeme.
+Toto je najlepšia pieseň, akú som tento týždeň počul, mal by si si ju vypočuť, keď budeš mať čas.
+Dobré ráno! Vyspal si sa dobre? Ja som bol hore celú noc, lebo som dokončoval domácu úlohu do školy.
+Povedali, že stretnutie presunuli na štvrtok poobede, takže zajtra nemusíš prísť.
+O koľkej začína stream? Chcem ho pozerať s kamarátmi po večeri.
+Bolo by super, keby sme si mohli cez víkend zahrať spolu, len mi povedz, ktorý deň ti vyhovuje.
+Učím sa variť a včera som urobil cestoviny s paradajkovou omáčkou pre celú rodinu.
+Nový film bol oveľa lepší, ako som čakal, aj keď koniec bol trochu zvláštny.
+Kde sú všetci? Na serveri je veľmi ticho, odkedy začali prázdniny.
+)"},
+    {"sl", "abcdefghijklmnopqrstuvwxyzčšž", R"(
+Živijo vsi, kako ste danes? Mislim, da bi morali zdaj začeti igro, ker je že pozno.
+Hvala za pomoč, res cenim. Ali kdo ve, kdaj bo izšla naslednja posodobitev?
+Zjutraj je bilo lepo vreme, zato smo šli s psom na sprehod v park.
+Ne vem, kaj se je zgodilo, računalnik je kar nehal delovati in zdaj moram vse znova zagnati.
+Mi lahko še enkrat pošlješ povezavo? Nisem je našel v kanalu.
+Kasneje gremo v trgovino, ali kaj potrebuješ? Povej mi, preden odidemo.
+To je najboljša pesem, kar sem jih slišal ta teden, poslušaj jo, ko boš imel čas.
+Dobro jutro! Si dobro spal? Jaz sem bil buden vso noč, ker sem delal domačo nalogo za šolo.
+Rekli so, da so sestanek prestavili na četrtek popoldne, tako da jutri ni treba priti.
+Ob kateri uri se začne prenos? Želim ga gledati s prijatelji po večerji.
+Super bi bilo, če bi lahko ta vikend igrali skupaj, samo povej mi, kateri dan ti ustreza.
+Učim se kuhati in včeraj sem za vso družino skuhal testenine s paradižnikovo omako.
+Novi film je bil veliko boljši, kot sem pričakoval, čeprav je bil konec malo čuden.
+Kje so vsi? Na strežniku je zelo tiho, odkar so se začele počitnice.
+)"},
+    {"hr", "abcdefghijklmnopqrstuvwxyzčćđšž", R"(
+Bok svima, kako ste danas? Mislim da bismo trebali sada početi igru jer je već kasno.
+Hvala na pomoći, stvarno to cijenim. Zna li netko kada izlazi sljedeće ažuriranje?
+Jutros je bilo lijepo vrijeme pa smo otišli u šetnju po parku sa psom.
+Ne znam što se dogodilo, računalo mi je jednostavno prestalo raditi i sad moram sve ponovno pokrenuti.
+Možeš li mi opet poslati poveznicu? Nisam je mogao pronaći na kanalu.
+Kasnije idemo u dućan, trebaš li nešto? Javi mi prije nego što krenemo.
+Ovo je najbolja pjesma koju sam čuo cijeli tjedan, trebao bi je poslušati kad budeš imao vremena.
+Dobro jutro! Jesi li se dobro naspavao? Ja sam bio budan cijelu noć i dovršavao zadaću za školu.
+Rekli su da je sastanak pomaknut na četvrtak poslijepodne, tako da sutra ne moraš dolaziti.
+U koliko sati počinje stream? Želim ga gledati s prijateljima nakon večere.
+Bilo bi super kad bismo ovaj vikend mogli igrati zajedno, samo mi reci koji ti dan odgovara.
+Učim kuhati i jučer sam napravio tjesteninu s umakom od rajčice za cijelu obitelj.
+Novi film bio je puno bolji nego što sam očekivao, iako je kraj bio malo čudan.
+Gdje su svi? Na serveru je jako tiho otkad su počeli praznici.
+)"},
+    {"et", "abcdefghijklmnopqrstuvwxyzäöõüšž", R"(
+Tere kõigile, kuidas teil täna läheb? Ma arvan, et peaksime mänguga nüüd alustama, sest juba hakkab hiljaks minema.
+Aitäh abi eest, ma tõesti hindan seda. Kas keegi teab, millal järgmine uuendus välja tuleb?
+Täna hommikul oli ilus ilm, nii et läksime koeraga pargis jalutama.
+Ma ei tea, mis juhtus, mu arvuti lihtsalt lakkas töötamast ja nüüd pean kõik uuesti käivitama.
+Kas sa saaksid mulle lingi uuesti saata? Ma ei leidnud seda kanalist.
+Me läheme hiljem poodi, kas sa tahad midagi? Anna mulle enne teada, kui me lahkume.
+See on parim laul, mida ma terve nädala jooksul kuulnud olen, sa peaksid seda kuulama, kui sul aega on.
+Tere hommikust! Kas sa magasid hästi? Ma olin terve öö üleval ja tegin koolile kodutöid.
+Nad ütlesid, et koosolek lükati neljapäeva pärastlõunale, nii et homme pole vaja tulla.
+Mis kell otseülekanne algab? Ma tahan seda pärast õhtusööki sõpradega vaadata.
+Oleks tore, kui saaksime sel nädalavahetusel koos mängida, ütle lihtsalt, milline päev sulle sobib.
+Ma olen õppinud süüa tegema ja eile tegin kogu perele tomatikastmega pastat.
+Uus film oli palju parem, kui ma ootasin, kuigi lõpp oli natuke kummaline.
+Kus kõik on? Serveris on olnud väga vaikne sellest ajast, kui pühad algasid.
+)"},
+    {"af", "abcdefghijklmnopqrstuvwxyzáäéèêëíîïóôöúûüý", R"(
+Hallo almal, hoe gaan dit vandag? Ek dink ons moet nou die speletjie begin, want dit word laat.
+Dankie vir die hulp, ek waardeer dit regtig. Weet iemand wanneer die volgende opdatering uitkom?
+Die weer was vanoggend lekker, so ons het saam met die hond in die park gaan stap.
+Ek weet nie wat gebeur het nie, my rekenaar het net opgehou werk en nou moet ek alles herbegin.
+Kan jy vir my die skakel weer stuur? Ek kon dit nie in die kanaal kry nie.
+Ons gaan later winkel toe, wil jy iets hê? Laat weet my asseblief voordat ons ry.
+Dit is die beste liedjie wat ek die hele week gehoor het, jy moet daarna luister wanneer jy tyd het.
+Goeiemôre! Het jy lekker geslaap? Ek was die hele nag wakker om my huiswerk vir die skool klaar te maak.
+Hulle het gesê die vergadering is na Donderdagmiddag geskuif, so jy hoef nie môre in te kom nie.
+Hoe laat begin die stroom? Ek wil dit ná aandete saam met my vriende kyk.
+Dit sal wonderlik wees as ons hierdie naweek saam kan speel, sê net vir my watter dag jou pas.
+Ek leer om te kook en gister het ek pasta met tamatiesous vir die hele gesin gemaak.
+Die nuwe fliek was baie beter as wat ek verwag het, al was die einde 'n bietjie vreemd.
+Waar is almal? Die bediener is baie stil sedert die vakansie begin het.
+)"},
+    {"ceb", "abcdefghijklmnopqrstuvwxyzñ", R"(
+Kumusta kamong tanan, unsay kahimtang ninyo karon? Sa akong hunahuna kinahanglan na nato sugdan ang dula kay gabii na.
+Salamat sa tabang, nagpasalamat gyud ko. Naa bay nakahibalo kanus-a mogawas ang sunod nga update?
+Nindot ang panahon ganinang buntag mao nga nilakaw mi sa parke uban sa iro.
+Wala ko kahibalo unsay nahitabo, kalit lang nihunong ang akong computer ug karon kinahanglan nakong i-restart tanan.
+Pwede nimo ipadala pag-usab ang link? Wala nako kini makit-i sa imong channel, ayaw kalimti.
+Moadto mi sa tindahan unya, naa ba kay gusto? Pahibaloa ko sa dili pa mi molakaw.
+Kini ang pinakanindot nga kanta nga akong nadungog karong semanaha, busa paminawa kini kung naa kay panahon.
+Maayong buntag! Nakatulog ka ba og maayo? Wala ko nakatulog tibuok gabii kay gihuman nako ang akong homework sa eskwelahan.
+Miingon sila nga ang miting gibalhin sa Huwebes sa hapon, mao nga dili na kinahanglan moanhi ugma.
+Unsang orasa magsugod ang stream? Gusto nako kining tan-awon uban sa akong mga higala human sa panihapon.
+Nindot unta kung makadula ta nga magkauban karong semanaha, sultihi lang ko kung unsang adlawa ang maayo nimo.
+Nagtuon ko pagluto ug gahapon nagluto ko og pasta nga adunay sarsa nga kamatis para sa tibuok pamilya.
+Ang bag-ong salida mas nindot kaysa akong gipaabot, bisan pa og medyo katingad-an ang katapusan.
+Asa man ang tanan? Nganong hilom kaayo ang server sukad nagsugod ang bakasyon?
+)"},
+    {"ru", "абвгдеёжзийклмнопрстуфхцчшщъыьэюя", R"(
+Всем привет, как у вас дела сегодня? Я думаю, нам пора начинать игру, потому что уже поздно.
+Спасибо за помощь, я правда очень это ценю. Кто-нибудь знает, когда выйдет следующее обновление?
+Сегодня утром была очень хорошая погода, поэтому мы пошли гулять в парк с собакой.
+Я не знаю, что случилось, мой компьютер просто перестал работать, и теперь мне нужно всё перезапускать.
+Можешь ещё раз отправить мне ссылку? Я не смог найти её в канале.
+Мы позже пойдём в магазин, тебе что-нибудь нужно? Скажи мне, пока мы не ушли.
+Это лучшая песня, которую я слышал за всю неделю, обязательно послушай её, когда будет время.
+Доброе утро! Ты хорошо выспался? Я всю ночь не спал, доделывал домашнее задание для школы.
+Они сказали, что встречу перенесли на четверг после обеда, так что завтра можно не приходить.
+Во сколько начинается стрим? Я хочу посмотреть его с друзьями после ужина.
+Было бы здорово, если бы мы смогли поиграть вместе в эти выходные, просто скажи, какой день тебе подходит.
+Я учусь готовить, и вчера сделал макароны с томатным соусом для всей семьи.
+Новый фильм оказался намного лучше, чем я ожидал, хотя концовка была немного странной.
+Где все? На сервере очень тихо с тех пор, как начались каникулы.
+)"},
+    {"uk", "абвгґдеєжзиіїйклмнопрстуфхцчшщьюя", R"(
+Всім привіт, як у вас справи сьогодні? Я думаю, нам час починати гру, бо вже пізно.
+Дякую за допомогу, я справді дуже це ціную. Хтось знає, коли вийде наступне оновлення?
+Сьогодні вранці була дуже гарна погода, тому ми пішли гуляти в парк із собакою.
+Я не знаю, що сталося, мій комп'ютер просто перестав працювати, і тепер мені треба все перезапускати.
+Можеш ще раз надіслати мені посилання? Я не зміг знайти його в каналі.
+Ми пізніше підемо до магазину, тобі щось потрібно? Скажи мені, поки ми не пішли.
+Це найкраща пісня, яку я чув за весь тиждень, обов'язково послухай її, коли буде час.
+Доброго ранку! Ти добре виспався? Я всю ніч не спав, доробляв домашнє завдання для школи.
+Вони сказали, що зустріч перенесли на четвер після обіду, тож завтра можна не приходити.
+О котрій починається стрім? Я хочу подивитися його з друзями після вечері.
+Було б чудово, якби ми змогли пограти разом цими вихідними, просто скажи, який день тобі підходить.
+Я вчуся готувати, і вчора зробив макарони з томатним соусом для всієї родини.
+Новий фільм виявився набагато кращим, ніж я очікував, хоча кінцівка була трохи дивною.
+Де всі? На сервері дуже тихо відтоді, як почалися канікули.
+)"},
+    {"bg", "абвгдежзийклмнопрстуфхцчшщъьюя", R"(
+Здравейте на всички, как сте днес? Мисля, че трябва да започнем играта сега, защото вече става късно.
+Благодаря за помощта, наистина я оценявам. Някой знае ли кога излиза следващата актуализация?
+Времето тази сутрин беше хубаво, затова отидохме на разходка в парка с кучето.
+Не знам какво стана, компютърът ми просто спря да работи и сега трябва да рестартирам всичко.
+Можеш ли да ми пратиш линка отново? Не можах да го намеря в канала.
+По-късно ще ходим до магазина, искаш ли нещо? Кажи ми, преди да тръгнем.
+Това е най-хубавата песен, която съм чул цялата седмица, трябва да я чуеш, когато имаш време.
+Добро утро! Наспа ли се? Аз бях буден цяла нощ, за да довърша домашното си за училище.
+Казаха, че срещата е преместена за четвъртък следобед, така че няма нужда да идваш утре.
+В колко часа започва стриймът? Искам да го гледам с приятелите си след вечеря.
+Би било страхотно, ако можем да играем заедно този уикенд, просто ми кажи кой ден ти е удобен.
+Уча се да готвя и вчера направих паста с доматен сос за цялото семейство.
+Новият филм беше много по-добър, отколкото очаквах, въпреки че краят беше малко странен.
+Къде са всички? Сървърът е много тих, откакто започнаха празниците.
+)"},
+};
+
+const size_t LANGUAGE_SAMPLE_COUNT = sizeof(LANGUAGE_SAMPLES) / sizeof(LANGUAGE_SAMPLES[0]);
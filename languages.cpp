@@ -0,0 +1,412 @@
+#include "languages.h"
+
+#include <array>
+#include <cstdint>
+
+constexpr Language LANGUAGES[] = {
+    {"af", "Afrikaans", "Afrikaans", "🇿🇦"},
+    {"sq", "Albanian", "Shqip", "🇦🇱"},
+    {"am", "Amharic", "አማርኛ", "🇪🇹"},
+    {"ar", "Arabic", "العربية", "🇸🇦"},
+    {"hy", "Armenian", "Հայերեն", "🇦🇲"},
+    {"as", "Assamese", "অসমীয়া", "🇮🇳"},
+    {"ay", "Aymara", "Aymar aru", "🇧🇴"},
+    {"az", "Azerbaijani", "Azərbaycanca", "🇦🇿"},
+    {"bm", "Bambara", "Bamanankan", "🇲🇱"},
+    {"eu", "Basque", "Euskara", "🇪🇸"},
+    {"be", "Belarusian", "Беларуская", "🇧🇾"},
+    {"bn", "Bengali", "বাংলা", "🇧🇩"},
+    {"bho", "Bhojpuri", "भोजपुरी", "🇮🇳"},
+    {"bs", "Bosnian", "Bosanski", "🇧🇦"},
+    {"bg", "Bulgarian", "Български", "🇧🇬"},
+    {"ca", "Catalan", "Català", "🇦🇩"},
+    {"ceb", "Cebuano", "Sinugbuanong Binisaya", "🇵🇭"},
+    {"ny", "Chichewa", "Chicheŵa", "🇲🇼"},
+    {"zh-CN", "Chinese (Simplified)", "简体中文", "🇨🇳"},
+    {"zh-TW", "Chinese (Traditional)", "繁體中文", "🇹🇼"},
+    {"co", "Corsican", "Corsu", "🇫🇷"},
+    {"hr", "Croatian", "Hrvatski", "🇭🇷"},
+    {"cs", "Czech", "Čeština", "🇨🇿"},
+    {"da", "Danish", "Dansk", "🇩🇰"},
+    {"dv", "Dhivehi", "ދިވެހި", "🇲🇻"},
+    {"doi", "Dogri", "डोगरी", "🇮🇳"},
+    {"nl", "Dutch", "Nederlands", "🇳🇱"},
+    {"en", "English", "English", "🇬🇧"},
+    {"eo", "Esperanto", "Esperanto", "🌐"},
+    {"et", "Estonian", "Eesti", "🇪🇪"},
+    {"ee", "Ewe", "Eʋegbe", "🇬🇭"},
+    {"tl", "Filipino", "Wikang Filipino", "🇵🇭"},
+    {"fi", "Finnish", "Suomi", "🇫🇮"},
+    {"fr", "French", "Français", "🇫🇷"},
+    {"fy", "Frisian", "Frysk", "🇳🇱"},
+    {"gl", "Galician", "Galego", "🇪🇸"},
+    {"ka", "Georgian", "ქართული", "🇬🇪"},
+    {"de", "German", "Deutsch", "🇩🇪"},
+    {"el", "Greek", "Ελληνικά", "🇬🇷"},
+    {"gn", "Guarani", "Avañeʼẽ", "🇵🇾"},
+    {"gu", "Gujarati", "ગુજરાતી", "🇮🇳"},
+    {"ht", "Haitian Creole", "Kreyòl ayisyen", "🇭🇹"},
+    {"ha", "Hausa", "Harshen Hausa", "🇳🇬"},
+    {"haw", "Hawaiian", "ʻŌlelo Hawaiʻi", "🇺🇸"},
+    {"iw", "Hebrew", "עברית", "🇮🇱"},
+    {"hi", "Hindi", "हिन्दी", "🇮🇳"},
+    {"hmn", "Hmong", "Hmoob", "🇱🇦"},
+    {"hu", "Hungarian", "Magyar", "🇭🇺"},
+    {"is", "Icelandic", "Íslenska", "🇮🇸"},
+    {"ig", "Igbo", "Asụsụ Igbo", "🇳🇬"},
+    {"ilo", "Ilocano", "Ilokano", "🇵🇭"},
+    {"id", "Indonesian", "Bahasa Indonesia", "🇮🇩"},
+    {"ga", "Irish", "Gaeilge", "🇮🇪"},
+    {"it", "Italian", "Italiano", "🇮🇹"},
+    {"ja", "Japanese", "日本語", "🇯🇵"},
+    {"jw", "Javanese", "Basa Jawa", "🇮🇩"},
+    {"kn", "Kannada", "ಕನ್ನಡ", "🇮🇳"},
+    {"kk", "Kazakh", "Қазақ тілі", "🇰🇿"},
+    {"km", "Khmer", "ភាសាខ្មែរ", "🇰🇭"},
+    {"rw", "Kinyarwanda", "Ikinyarwanda", "🇷🇼"},
+    {"gom", "Konkani", "कोंकणी", "🇮🇳"},
+    {"ko", "Korean", "한국어", "🇰🇷"},
+    {"kri", "Krio", "Krio Langwej", "🇸🇱"},
+    {"ku", "Kurdish (Kurmanji)", "Kurmancî", "🇹🇷"},
+    {"ckb", "Kurdish (Sorani)", "کوردیی ناوەندی", "🇮🇶"},
+    {"ky", "Kyrgyz", "Кыргызча", "🇰🇬"},
+    {"lo", "Lao", "ພາສາລາວ", "🇱🇦"},
+    {"la", "Latin", "Latina", "🇻🇦"},
+    {"lv", "Latvian", "Latviešu", "🇱🇻"},
+    {"ln", "Lingala", "Lingála", "🇨🇩"},
+    {"lt", "Lithuanian", "Lietuvių", "🇱🇹"},
+    {"lg", "Luganda", "Oluganda", "🇺🇬"},
+    {"lb", "Luxembourgish", "Lëtzebuergesch", "🇱🇺"},
+    {"mk", "Macedonian", "Македонски", "🇲🇰"},
+    {"mai", "Maithili", "मैथिली", "🇮🇳"},
+    {"mg", "Malagasy", "Fiteny Malagasy", "🇲🇬"},
+    {"ms", "Malay", "Bahasa Melayu", "🇲🇾"},
+    {"ml", "Malayalam", "മലയാളം", "🇮🇳"},
+    {"mt", "Maltese", "Malti", "🇲🇹"},
+    {"mi", "Maori", "Te Reo Māori", "🇳🇿"},
+    {"mr", "Marathi", "मराठी", "🇮🇳"},
+    {"mni-Mtei", "Meiteilon (Manipuri)", "ꯃꯤꯇꯩꯂꯣꯟ", "🇮🇳"},
+    {"lus", "Mizo", "Mizo ṭawng", "🇮🇳"},
+    {"mn", "Mongolian", "Монгол", "🇲🇳"},
+    {"my", "Myanmar (Burmese)", "မြန်မာ", "🇲🇲"},
+    {"ne", "Nepali", "नेपाली", "🇳🇵"},
+    {"no", "Norwegian", "Norsk", "🇳🇴"},
+    {"or", "Odia (Oriya)", "ଓଡ଼ିଆ", "🇮🇳"},
+    {"om", "Oromo", "Afaan Oromoo", "🇪🇹"},
+    {"ps", "Pashto", "پښتو", "🇦🇫"},
+    {"fa", "Persian", "فارسی", "🇮🇷"},
+    {"pl", "Polish", "Polski", "🇵🇱"},
+    {"pt", "Portuguese", "Português", "🇵🇹"},
+    {"pa", "Punjabi", "ਪੰਜਾਬੀ", "🇮🇳"},
+    {"qu", "Quechua", "Runa Simi", "🇵🇪"},
+    {"ro", "Romanian", "Română", "🇷🇴"},
+    {"ru", "Russian", "Русский", "🇷🇺"},
+    {"sm", "Samoan", "Gagana Sāmoa", "🇼🇸"},
+    {"sa", "Sanskrit", "संस्कृतम्", "🇮🇳"},
+    {"gd", "Scots Gaelic", "Gàidhlig", "🏴󠁧󠁢󠁳󠁣󠁴󠁿"},
+    {"nso", "Sepedi", "Sesotho sa Leboa", "🇿🇦"},
+    {"sr", "Serbian", "Српски", "🇷🇸"},
+    {"st", "Sesotho", "Sesotho sa Borwa", "🇱🇸"},
+    {"sn", "Shona", "chiShona", "🇿🇼"},
+    {"sd", "Sindhi", "سنڌي", "🇵🇰"},
+    {"si", "Sinhala", "සිංහල", "🇱🇰"},
+    {"sk", "Slovak", "Slovenčina", "🇸🇰"},
+    {"sl", "Slovenian", "Slovenščina", "🇸🇮"},
+    {"so", "Somali", "Soomaali", "🇸🇴"},
+    {"es", "Spanish", "Español", "🇪🇸"},
+    {"su", "Sundanese", "Basa Sunda", "🇮🇩"},
+    {"sw", "Swahili", "Kiswahili", "🇰🇪"},
+    {"sv", "Swedish", "Svenska", "🇸🇪"},
+    {"tg", "Tajik", "Тоҷикӣ", "🇹🇯"},
+    {"ta", "Tamil", "தமிழ்", "🇮🇳"},
+    {"tt", "Tatar", "Татар теле", "🇷🇺"},
+    {"te", "Telugu", "తెలుగు", "🇮🇳"},
+    {"th", "Thai", "ภาษาไทย", "🇹🇭"},
+    {"ti", "Tigrinya", "ትግርኛ", "🇪🇷"},
+    {"ts", "Tsonga", "Xitsonga", "🇿🇦"},
+    {"tr", "Turkish", "Türkçe", "🇹🇷"},
+    {"tk", "Turkmen", "Türkmençe", "🇹🇲"},
+    {"ak", "Twi", "Akan Twi", "🇬🇭"},
+    {"uk", "Ukrainian", "Українська", "🇺🇦"},
+    {"ur", "Urdu", "اردو", "🇵🇰"},
+    {"ug", "Uyghur", "ئۇيغۇرچە", "🇨🇳"},
+    {"uz", "Uzbek", "Oʻzbekcha", "🇺🇿"},
+    {"vi", "Vietnamese", "Tiếng Việt", "🇻🇳"},
+    {"cy", "Welsh", "Cymraeg", "🏴󠁧󠁢󠁷󠁬󠁳󠁿"},
+    {"xh", "Xhosa", "isiXhosa", "🇿🇦"},
+    {"yi", "Yiddish", "ייִדיש", "🌐"},
+    {"yo", "Yoruba", "Èdè Yorùbá", "🇳🇬"},
+    {"zu", "Zulu", "isiZulu", "🇿🇦"},
+};
+
+const size_t LANGUAGE_COUNT = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+
+struct Alias {
+    std::string_view alias;
+    std::string_view code;
+};
+
+// Other names users type, and codes other services use for the same language
+constexpr Alias NAME_ALIASES[] = {
+    {"chinese", "zh-CN"}, {"simplified chinese", "zh-CN"}, {"mandarin", "zh-CN"},
+    {"traditional chinese", "zh-TW"}, {"tagalog", "tl"}, {"farsi", "fa"},
+    {"burmese", "my"}, {"myanmar", "my"}, {"odia", "or"}, {"oriya", "or"},
+    {"kurdish", "ku"}, {"kurmanji", "ku"}, {"sorani", "ckb"}, {"gaelic", "gd"},
+    {"scottish gaelic", "gd"}, {"haitian", "ht"}, {"creole", "ht"}, {"akan", "ak"},
+    {"manipuri", "mni-Mtei"}, {"meitei", "mni-Mtei"}, {"northern sotho", "nso"},
+    {"sotho", "st"}, {"nyanja", "ny"}, {"bokmal", "no"}, {"sinhalese", "si"},
+    {"panjabi", "pa"}, {"pushto", "ps"}, {"kirghiz", "ky"}, {"uighur", "ug"},
+    {"maldivian", "dv"}, {"letzeburgesch", "lb"}, {"flemish", "nl"}, {"castilian", "es"},
+    {"moldovan", "ro"}, {"slovene", "sl"}, {"valencian", "ca"}, {"bangla", "bn"},
+};
+
+constexpr Alias CODE_ALIASES[] = {
+    {"he", "iw"}, {"jv", "jw"}, {"zh", "zh-CN"}, {"zh-Hans", "zh-CN"}, {"zh-Hant", "zh-TW"},
+    {"fil", "tl"}, {"nb", "no"}, {"nn", "no"}, {"mni", "mni-Mtei"}, {"fy-NL", "fy"},
+    {"pt-PT", "pt"}, {"pt-BR", "pt"}, {"en-US", "en"}, {"en-GB", "en"},
+};
+
+constexpr size_t NAME_ALIAS_COUNT = sizeof(NAME_ALIASES) / sizeof(NAME_ALIASES[0]);
+constexpr size_t CODE_ALIAS_COUNT = sizeof(CODE_ALIASES) / sizeof(CODE_ALIASES[0]);
+constexpr size_t TABLE_SIZE = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+
+static_assert(TABLE_SIZE >= 100, "the registry is meant to cover at least 100 languages");
+
+constexpr char ascii_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equal_folded(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (ascii_lower(a[i]) != ascii_lower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// FNV-1a over the ASCII-lowercased key, seeded, with a final mix so nearby
+// seeds give unrelated slots
+constexpr uint32_t folded_hash(std::string_view key, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char c : key) {
+        hash = (hash ^ static_cast<unsigned char>(ascii_lower(c))) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+constexpr size_t table_index(std::string_view code) {
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+        if (LANGUAGES[i].code == code) {
+            return i;
+        }
+    }
+    throw "alias of an unknown language code";
+}
+
+constexpr size_t next_power_of_two(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+// Keys and the language each stands for. The same key may be listed twice
+// for one language (a native name equal to the English one); for two
+// languages it fails the build.
+template <size_t Capacity>
+struct KeySet {
+    std::array<std::string_view, Capacity> keys{};
+    std::array<uint8_t, Capacity> languages{};
+    size_t size = 0;
+
+    constexpr void add(std::string_view key, size_t language) {
+        for (size_t i = 0; i < size; ++i) {
+            if (equal_folded(keys[i], key)) {
+                if (languages[i] != language) {
+                    throw "key shared by two languages";
+                }
+                return;
+            }
+        }
+        keys[size] = key;
+        languages[size] = static_cast<uint8_t>(language);
+        ++size;
+    }
+};
+
+static_assert(TABLE_SIZE < 256, "language indexes are stored in a byte");
+
+// Hash and displace: keys are split over buckets by one hash, and each
+// bucket gets the first seed that sends all its keys to free slots. A
+// lookup is then two hashes and one comparison.
+template <size_t Keys>
+struct PerfectHash {
+    static constexpr size_t BUCKETS = next_power_of_two(Keys / 4 + 1);
+    static constexpr size_t SLOTS = next_power_of_two(Keys * 2);
+
+    std::array<uint16_t, BUCKETS> seeds{};
+    std::array<uint16_t, SLOTS> slots{};  // Key index + 1, 0 for a free slot
+    KeySet<Keys> set{};
+
+    constexpr explicit PerfectHash(const KeySet<Keys>& keys) : set(keys) {
+        // Bucket members, grouped with a counting sort
+        std::array<size_t, BUCKETS + 1> starts{};
+        std::array<uint16_t, Keys> members{};
+        for (size_t k = 0; k < set.size; ++k) {
+            ++starts[(folded_hash(set.keys[k], 0) & (BUCKETS - 1)) + 1];
+        }
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            starts[b + 1] += starts[b];
+        }
+        std::array<size_t, BUCKETS> filled{};
+        for (size_t k = 0; k < set.size; ++k) {
+            size_t b = folded_hash(set.keys[k], 0) & (BUCKETS - 1);
+            members[starts[b] + filled[b]++] = static_cast<uint16_t>(k);
+        }
+
+        // Largest buckets first, while most slots are free
+        std::array<size_t, BUCKETS> order{};
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            order[b] = b;
+        }
+        for (size_t i = 1; i < BUCKETS; ++i) {
+            for (size_t j = i; j > 0 && filled[order[j]] > filled[order[j - 1]]; --j) {
+                size_t swap = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = swap;
+            }
+        }
+
+        for (size_t b : order) {
+            if (filled[b] == 0) {
+                break;
+            }
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed > 0xFFFF) {
+                    throw "no seed places this bucket";
+                }
+                std::array<size_t, Keys> chosen{};
+                bool placed = true;
+                for (size_t m = 0; m < filled[b] && placed; ++m) {
+                    size_t slot = folded_hash(set.keys[members[starts[b] + m]], seed) & (SLOTS - 1);
+                    placed = slots[slot] == 0;
+                    for (size_t earlier = 0; earlier < m && placed; ++earlier) {
+                        placed = chosen[earlier] != slot;
+                    }
+                    chosen[m] = slot;
+                }
+                if (placed) {
+                    for (size_t m = 0; m < filled[b]; ++m) {
+                        slots[chosen[m]] = static_cast<uint16_t>(members[starts[b] + m] + 1);
+                    }
+                    seeds[b] = static_cast<uint16_t>(seed);
+                    break;
+                }
+            }
+        }
+    }
+
+    constexpr const Language* find(std::string_view key) const {
+        uint32_t seed = seeds[folded_hash(key, 0) & (BUCKETS - 1)];
+        uint16_t entry = slots[folded_hash(key, seed) & (SLOTS - 1)];
+        if (entry == 0 || !equal_folded(set.keys[entry - 1], key)) {
+            return nullptr;
+        }
+        return &LANGUAGES[set.languages[entry - 1]];
+    }
+};
+
+constexpr size_t NAME_KEY_CAPACITY = TABLE_SIZE * 3 + NAME_ALIAS_COUNT + CODE_ALIAS_COUNT;
+constexpr size_t CODE_KEY_CAPACITY = TABLE_SIZE + CODE_ALIAS_COUNT;
+
+// Everything a user may type: names, native names, codes and aliases
+constexpr KeySet<NAME_KEY_CAPACITY> name_keys() {
+    KeySet<NAME_KEY_CAPACITY> set;
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+        set.add(LANGUAGES[i].name, i);
+        set.add(LANGUAGES[i].native, i);
+        set.add(LANGUAGES[i].code, i);
+    }
+    for (const Alias& alias : NAME_ALIASES) {
+        set.add(alias.alias, table_index(alias.code));
+    }
+    for (const Alias& alias : CODE_ALIASES) {
+        set.add(alias.alias, table_index(alias.code));
+    }
+    return set;
+}
+
+constexpr KeySet<CODE_KEY_CAPACITY> code_keys() {
+    KeySet<CODE_KEY_CAPACITY> set;
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+        set.add(LANGUAGES[i].code, i);
+    }
+    for (const Alias& alias : CODE_ALIASES) {
+        set.add(alias.alias, table_index(alias.code));
+    }
+    return set;
+}
+
+static constexpr PerfectHash<NAME_KEY_CAPACITY> NAME_INDEX(name_keys());
+static constexpr PerfectHash<CODE_KEY_CAPACITY> CODE_INDEX(code_keys());
+
+static_assert(NAME_INDEX.find("Deutsch")->code == "de" && NAME_INDEX.find("FARSI")->code == "fa" &&
+              NAME_INDEX.find("zh-cn")->code == "zh-CN" && !NAME_INDEX.find("xx"),
+              "name index lookups");
+static_assert(CODE_INDEX.find("he")->code == "iw" && !CODE_INDEX.find("english"), "code index lookups");
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+const Language* find_language(std::string_view input) {
+    while (!input.empty() && is_space(input.front())) {
+        input.remove_prefix(1);
+    }
+    while (!input.empty() && is_space(input.back())) {
+        input.remove_suffix(1);
+    }
+    return NAME_INDEX.find(input);
+}
+
+const Language* language_by_code(std::string_view code) {
+    return CODE_INDEX.find(code);
+}
+
+std::string_view language_flag(std::string_view code) {
+    const Language* language = CODE_INDEX.find(code);
+    return language ? language->flag : "🌐";
+}
+
+static bool starts_with_folded(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && equal_folded(text.substr(0, prefix.size()), prefix);
+}
+
+size_t complete_language(std::string_view prefix, const Language** out, size_t max) {
+    while (!prefix.empty() && is_space(prefix.front())) {
+        prefix.remove_prefix(1);
+    }
+
+    size_t count = 0;
+    std::array<bool, TABLE_SIZE> taken{};
+    for (size_t i = 0; i < TABLE_SIZE && count < max; ++i) {
+        if (starts_with_folded(LANGUAGES[i].name, prefix)) {
+            taken[i] = true;
+            out[count++] = &LANGUAGES[i];
+        }
+    }
+    for (size_t i = 0; i < TABLE_SIZE && count < max; ++i) {
+        if (!taken[i] && (starts_with_folded(LANGUAGES[i].native, prefix) || starts_with_folded(LANGUAGES[i].code, prefix))) {
+            out[count++] = &LANGUAGES[i];
+        }
+    }
+    return count;
+}
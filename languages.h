@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// A language the bot translates to and from. Codes are the Google-style ones
+// the backends take ("zh-CN", "iw"); backends that use other codes convert.
+struct Language {
+    std::string_view code;
+    std::string_view name;    // English name, as listed in /languages
+    std::string_view native;  // Name in the language itself
+    std::string_view flag;    // Emoji shown next to translations
+};
+
+// Every supported language, sorted by English name. A constant table, so
+// lookups never allocate and are safe from any thread.
+extern const Language LANGUAGES[];
+extern const size_t LANGUAGE_COUNT;
+
+// Language for a name, native name, code or alias ("farsi", "he") typed by
+// a user, ignoring ASCII case and surrounding spaces; nullptr if unknown
+const Language* find_language(std::string_view input);
+
+// Language for a code, such as one stored in settings or reported by
+// detection; aliases like "he" or "zh" are accepted. nullptr if unknown.
+const Language* language_by_code(std::string_view code);
+
+// Flag for a language code, or a globe if there is none
+std::string_view language_flag(std::string_view code);
+
+// Up to max languages whose English name, native name or code starts with
+// prefix (ASCII case ignored), English name matches first, for slash
+// command autocomplete. Returns how many were written to out.
+size_t complete_language(std::string_view prefix, const Language** out, size_t max);
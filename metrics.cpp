@@ -0,0 +1,334 @@
+#include "metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// Upper bounds of the histogram buckets, in seconds
+static const std::array<double, 16> BUCKETS = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+    0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0,
+};
+
+// Slots per histogram: one per bucket, +Inf, and the sum
+static const uint32_t HISTOGRAM_SLOTS = BUCKETS.size() + 2;
+
+// Every thread's buffer has room for this many slots
+static const uint32_t MAX_SLOTS = 1024;
+static const uint32_t NO_SLOT = UINT32_MAX;
+
+namespace {
+
+struct MetricInfo {
+    std::string name;
+    std::string help;
+    std::string labels;
+    bool histogram;
+    uint32_t slot;
+};
+
+// Slots written only by the owning thread; other threads read them
+struct ThreadBuffer {
+    std::array<std::atomic<uint64_t>, MAX_SLOTS> slots{};
+
+    ThreadBuffer();
+    ~ThreadBuffer();
+
+    void add(uint32_t slot, uint64_t n) {
+        // Single writer, so a relaxed load and store is enough
+        slots[slot].store(slots[slot].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+struct Registry {
+    std::mutex mutex;  // Guards the lists below; never taken while recording
+    std::vector<MetricInfo> metrics;
+    std::vector<ThreadBuffer*> buffers;
+    std::array<uint64_t, MAX_SLOTS> retired{};  // Totals from threads that have exited
+    uint32_t next_slot = 0;
+
+    uint32_t add(std::string name, std::string help, std::string labels, bool histogram) {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t size = histogram ? HISTOGRAM_SLOTS : 1;
+        if (next_slot + size > MAX_SLOTS) {
+            std::cerr << "Metric " << name << " not recorded: out of slots" << std::endl;
+            return NO_SLOT;
+        }
+        uint32_t slot = next_slot;
+        next_slot += size;
+        metrics.push_back({std::move(name), std::move(help), std::move(labels), histogram, slot});
+        return slot;
+    }
+
+    std::vector<uint64_t> totals() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<uint64_t> values(retired.begin(), retired.begin() + next_slot);
+        for (ThreadBuffer* buffer : buffers) {
+            for (uint32_t i = 0; i < next_slot; ++i) {
+                values[i] += buffer->slots[i].load(std::memory_order_relaxed);
+            }
+        }
+        return values;
+    }
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadBuffer::ThreadBuffer() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.push_back(this);
+}
+
+ThreadBuffer::~ThreadBuffer() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (uint32_t i = 0; i < MAX_SLOTS; ++i) {
+        r.retired[i] += slots[i].load(std::memory_order_relaxed);
+    }
+    r.buffers.erase(std::find(r.buffers.begin(), r.buffers.end(), this));
+}
+
+ThreadBuffer& thread_buffer() {
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+struct Collectors {
+    std::mutex mutex;  // Held while collecting, so removal waits for a render in progress
+    std::map<uint64_t, std::function<void(std::ostream&)>> functions;
+    uint64_t next_id = 1;
+};
+
+Collectors& collectors() {
+    static Collectors instance;
+    return instance;
+}
+
+}  // namespace
+
+Counter::Counter(std::string name, std::string help, std::string labels)
+    : slot_(registry().add(std::move(name), std::move(help), std::move(labels), false)) {}
+
+void Counter::add(uint64_t n) {
+    if (slot_ != NO_SLOT) {
+        thread_buffer().add(slot_, n);
+    }
+}
+
+Histogram::Histogram(std::string name, std::string help, std::string labels)
+    : slot_(registry().add(std::move(name), std::move(help), std::move(labels), true)) {}
+
+void Histogram::observe(double seconds) {
+    if (slot_ == NO_SLOT) {
+        return;
+    }
+
+    uint32_t bucket = std::lower_bound(BUCKETS.begin(), BUCKETS.end(), seconds) - BUCKETS.begin();
+    ThreadBuffer& buffer = thread_buffer();
+    buffer.add(slot_ + bucket, 1);
+    buffer.add(slot_ + HISTOGRAM_SLOTS - 1, static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9));
+}
+
+uint64_t add_metrics_collector(std::function<void(std::ostream&)> collector) {
+    Collectors& c = collectors();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    uint64_t id = c.next_id++;
+    c.functions.emplace(id, std::move(collector));
+    return id;
+}
+
+void remove_metrics_collector(uint64_t id) {
+    Collectors& c = collectors();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.functions.erase(id);
+}
+
+static std::string with_labels(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) {
+        return "";
+    }
+    if (labels.empty() || extra.empty()) {
+        return "{" + labels + extra + "}";
+    }
+    return "{" + labels + "," + extra + "}";
+}
+
+std::string render_metrics() {
+    Registry& r = registry();
+    std::vector<uint64_t> values = r.totals();
+
+    std::vector<MetricInfo> metrics;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        metrics = r.metrics;
+    }
+
+    // Series of the same metric must be adjacent, under one HELP/TYPE header
+    std::stable_sort(metrics.begin(), metrics.end(),
+                     [](const MetricInfo& a, const MetricInfo& b) { return a.name < b.name; });
+
+    std::ostringstream out;
+    const std::string* previous = nullptr;
+    for (const auto& metric : metrics) {
+        if (metric.slot >= values.size()) {
+            continue;
+        }
+
+        if (!previous || *previous != metric.name) {
+            out << "# HELP " << metric.name << " " << metric.help << "\n";
+            out << "# TYPE " << metric.name << (metric.histogram ? " histogram" : " counter") << "\n";
+        }
+        previous = &metric.name;
+
+        if (!metric.histogram) {
+            out << metric.name << with_labels(metric.labels) << " " << values[metric.slot] << "\n";
+            continue;
+        }
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i <= BUCKETS.size(); ++i) {
+            cumulative += values[metric.slot + i];
+            std::ostringstream le;
+            if (i < BUCKETS.size()) {
+                le << BUCKETS[i];
+            } else {
+                le << "+Inf";
+            }
+            out << metric.name << "_bucket" << with_labels(metric.labels, "le=\"" + le.str() + "\"") << " "
+                << cumulative << "\n";
+        }
+        out << metric.name << "_sum" << with_labels(metric.labels) << " "
+            << values[metric.slot + HISTOGRAM_SLOTS - 1] / 1e9 << "\n";
+        out << metric.name << "_count" << with_labels(metric.labels) << " " << cumulative << "\n";
+    }
+
+    Collectors& c = collectors();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    for (const auto& [id, collect] : c.functions) {
+        collect(out);
+    }
+
+    return out.str();
+}
+
+bool dump_metrics(const std::string& path) {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error writing metrics to " << tmp_path << std::endl;
+            return false;
+        }
+        out << render_metrics();
+        if (!out.good()) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& address, int port) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+        bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 16) != 0) {
+        std::cerr << "Cannot listen for metrics on " << address << ":" << port << std::endl;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    stopping_ = false;
+    thread_ = std::thread(&MetricsServer::serve, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    stopping_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsServer::serve() {
+    while (!stopping_) {
+        // Wake up regularly to notice stop()
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 500) <= 0) {
+            continue;
+        }
+
+        int client = accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        // A scraper that stops reading or writing must not hold up the next one
+        timeval timeout{2, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // Only the request line matters
+        char request[1024];
+        ssize_t received = recv(client, request, sizeof(request) - 1, 0);
+        std::string line = received > 0 ? std::string(request, received) : "";
+        line = line.substr(0, line.find("\r\n"));
+
+        std::string status = "200 OK";
+        std::string body;
+        if (line.rfind("GET /metrics ", 0) == 0 || line.rfind("GET / ", 0) == 0) {
+            body = render_metrics();
+        } else {
+            status = "404 Not Found";
+            body = "Not found\n";
+        }
+
+        std::string response = "HTTP/1.1 " + status +
+                               "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t n = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            sent += n;
+        }
+        close(client);
+    }
+}
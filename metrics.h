@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Process-wide counters and latency histograms.
+//
+// Each thread records into its own buffer of slots, so recording is a plain
+// add to thread-local memory with no lock and no shared cache line. Reading
+// (for the /metrics endpoint or a file dump) sums every thread's buffer.
+// Metrics are meant to be defined once, as globals or function statics.
+
+class Counter {
+public:
+    // labels is a Prometheus label list without braces, e.g. result="ok"
+    Counter(std::string name, std::string help, std::string labels = "");
+
+    void add(uint64_t n = 1);
+
+private:
+    uint32_t slot_;
+};
+
+class Histogram {
+public:
+    Histogram(std::string name, std::string help, std::string labels = "");
+
+    void observe(double seconds);
+    void observe(std::chrono::steady_clock::duration elapsed) {
+        observe(std::chrono::duration<double>(elapsed).count());
+    }
+
+private:
+    uint32_t slot_;  // Bucket counts, then the sum in nanoseconds
+};
+
+// Extra series with labels only known at run time (e.g. one per guild).
+// The collector writes complete exposition lines, HELP and TYPE included,
+// and is called on every render until it is removed.
+uint64_t add_metrics_collector(std::function<void(std::ostream& out)> collector);
+void remove_metrics_collector(uint64_t id);
+
+// All metrics in the Prometheus text exposition format
+std::string render_metrics();
+
+// Write render_metrics() to path, replacing it atomically
+bool dump_metrics(const std::string& path);
+
+// Minimal HTTP server answering GET /metrics on its own thread
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool start(const std::string& address, int port);
+    void stop();
+
+private:
+    void serve();
+
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+};
@@ -0,0 +1,575 @@
+#include "reply_dispatcher.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "config.h"
+#include "event_loop.h"
+#include "metrics.h"
+
+// Discord's limits, counted in bytes, which is never less than Discord's count
+static const size_t EMBED_DESCRIPTION_MAX = 4096;
+static const size_t MESSAGE_TEXT_MAX = 6000;
+static const size_t MESSAGE_EMBEDS_MAX = 10;
+
+// Room for the footer the sink adds and a section's link, so any one
+// section fits in a message of its own
+static const size_t FOOTER_RESERVE = 64;
+static const size_t SECTION_TEXT_MAX = MESSAGE_TEXT_MAX - FOOTER_RESERVE - 256;
+
+// A reply whose create or edit keeps failing is most likely unwelcome or
+// gone; stop retrying then
+static const int MAX_SEND_RETRIES = 3;
+
+// Channels idle this long are forgotten
+static const std::chrono::minutes CHANNEL_IDLE(10);
+
+static Histogram reply_lag("auto_translate_reply_lag_seconds",
+                           "Time from translations being ready to Discord confirming the reply that shows them");
+static Counter replies_created("auto_translate_reply_messages_total", "Auto-translate reply messages posted");
+static Counter sections_posted("auto_translate_reply_sections_total", "Original messages answered by the reply messages posted");
+static Counter deferred_flushes("auto_translate_reply_deferred_total",
+                                "Reply flushes held back until a channel's REST budget refilled");
+
+DispatcherOptions dispatcher_options_from_config() {
+    DispatcherOptions options;
+    options.window = std::chrono::milliseconds(std::max<long>(config_int("REPLY_COALESCE_WINDOW_MS", options.window.count()), 0));
+    options.channel_budget = std::max<long>(config_int("REPLY_CHANNEL_BUDGET", options.channel_budget), 1);
+    options.budget_period = std::chrono::seconds(std::max<long>(config_int("REPLY_CHANNEL_BUDGET_SECONDS", options.budget_period.count()), 1));
+    options.retained_replies = std::max<long>(config_int("REPLY_MERGED_RETAINED", options.retained_replies), 1);
+    return options;
+}
+
+// Largest prefix of text no longer than max bytes that ends on a character
+static size_t utf8_floor(std::string_view text, size_t max) {
+    if (text.size() <= max) {
+        return text.size();
+    }
+    size_t cut = max;
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+        --cut;
+    }
+    return cut;
+}
+
+// Append a block of lines to the embed descriptions, blank-line separated
+// from the previous block, starting a new embed whenever the current one is
+// full. Lines stay whole unless one alone is too long for an embed.
+static void append_block(std::vector<std::string>& embeds, const std::string& block) {
+    std::string_view separator = "\n\n";
+    size_t pos = 0;
+    do {
+        size_t end = std::min(block.find('\n', pos), block.size());
+        std::string_view line(block.data() + pos, end - pos);
+        pos = end + 1;
+
+        while (true) {
+            std::string& current = embeds.back();
+            size_t joined = current.empty() ? line.size() : current.size() + separator.size() + line.size();
+            if (joined <= EMBED_DESCRIPTION_MAX) {
+                if (!current.empty()) {
+                    current.append(separator);
+                }
+                current.append(line);
+                break;
+            }
+            if (current.empty()) {
+                size_t cut = utf8_floor(line, EMBED_DESCRIPTION_MAX);
+                current.append(line.substr(0, cut));
+                line.remove_prefix(cut);
+            }
+            embeds.emplace_back();
+        }
+        separator = "\n";
+    } while (pos <= block.size());
+}
+
+static std::string jump_link(const ReplyOrigin& origin) {
+    return "[↪ Message](https://discord.com/channels/" + std::to_string(origin.guild_id) + "/" +
+           std::to_string(origin.channel_id) + "/" + std::to_string(origin.id) + ")";
+}
+
+ReplyDispatcher::ReplyDispatcher(ReplySink& sink, ReplyIndex& replies, DispatcherOptions options)
+    : sink_(sink), replies_(replies), options_(std::move(options)), pruned_at_(Clock::now()) {
+    collector_id_ = add_metrics_collector([this](std::ostream& out) { write_metrics(out); });
+}
+
+ReplyDispatcher::~ReplyDispatcher() {
+    remove_metrics_collector(collector_id_);
+}
+
+void ReplyDispatcher::update(const ReplyOrigin& origin, const std::string& source_lang, const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    Channel& channel = channels_[origin.channel_id];
+    channel.last_active = now;
+
+    auto it = sections_.find(origin.id);
+    if (it == sections_.end()) {
+        Section section;
+        section.origin = origin;
+
+        // Already answered by a reply that is no longer in memory
+        ReplyRecord record;
+        if (replies_.find(origin.id, record) && record.reply_id) {
+            if (record.shared) {
+                ++stats_.unavailable;
+                return;
+            }
+            section.reply = std::make_shared<Reply>();
+            section.reply->id = record.reply_id;
+            section.reply->channel_id = origin.channel_id;
+            section.reply->sections.push_back(origin.id);
+        } else {
+            channel.pending.push_back(origin.id);
+        }
+        it = sections_.emplace(origin.id, std::move(section)).first;
+    }
+
+    Section& section = it->second;
+    section.source_lang = source_lang;
+    section.text.assign(text, 0, utf8_floor(text, SECTION_TEXT_MAX));
+    if (section.text.size() < text.size()) {
+        section.text += "…";
+    }
+    section.changed_at = now;
+
+    if (section.reply) {
+        mark_dirty(channel, section.reply);
+    }
+    schedule(origin.channel_id, channel, now);
+}
+
+bool ReplyDispatcher::remove(uint64_t original_id, uint64_t channel_id) {
+    Actions actions;
+    bool removed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        Channel& channel = channels_[channel_id];
+        channel.last_active = now;
+
+        ReplyRecord record;
+        bool indexed = replies_.erase(original_id, &record);
+
+        auto it = sections_.find(original_id);
+        if (it != sections_.end()) {
+            std::shared_ptr<Reply> reply = it->second.reply;
+            sections_.erase(it);
+            if (!reply) {
+                channel.pending.erase(std::remove(channel.pending.begin(), channel.pending.end(), original_id),
+                                      channel.pending.end());
+                return true;
+            }
+
+            // Edited out of its reply, or the reply deleted once it has no sections left
+            reply->sections.erase(std::remove(reply->sections.begin(), reply->sections.end(), original_id),
+                                  reply->sections.end());
+            mark_dirty(channel, reply);
+            schedule(channel_id, channel, now);
+            removed = true;
+        } else if (indexed && record.reply_id) {
+            if (record.shared) {
+                ++stats_.unavailable;
+            } else {
+                count_call(channel, now);
+                ++stats_.deletes;
+                uint64_t reply_id = record.reply_id;
+                actions.push_back([this, channel_id, reply_id] { sink_.remove(channel_id, reply_id); });
+                removed = true;
+            }
+        }
+    }
+
+    for (auto& action : actions) {
+        action();
+    }
+    return removed;
+}
+
+DispatcherStats ReplyDispatcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DispatcherStats stats = stats_;
+    stats.channels = channels_.size();
+    for (const auto& [id, channel] : channels_) {
+        stats.pending += channel.pending.size();
+    }
+    return stats;
+}
+
+void ReplyDispatcher::schedule(uint64_t channel_id, Channel& channel, Clock::time_point now) {
+    if (channel.scheduled) {
+        return;
+    }
+    channel.scheduled = true;
+
+    while (!channel.calls.empty() && now - channel.calls.front() >= options_.budget_period) {
+        channel.calls.pop_front();
+    }
+
+    // A busy channel gathers its replies for a window; a quiet one is answered at once
+    Clock::duration delay = Clock::duration::zero();
+    if (!channel.calls.empty() && now - channel.calls.back() < options_.window) {
+        delay = options_.window;
+    }
+
+    // With the budget spent, wait until enough calls have left the period
+    if (channel.calls.size() >= options_.channel_budget) {
+        Clock::time_point refill = channel.calls[channel.calls.size() - options_.channel_budget] + options_.budget_period;
+        if (refill - now > delay) {
+            delay = refill - now;
+            ++stats_.deferred;
+            deferred_flushes.add();
+        }
+    }
+
+    std::weak_ptr<ReplyDispatcher> self = weak_from_this();
+    event_loop().post_after(delay, [self, channel_id] {
+        if (auto dispatcher = self.lock()) {
+            dispatcher->flush(channel_id);
+        }
+    });
+}
+
+void ReplyDispatcher::flush(uint64_t channel_id) {
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = channels_.find(channel_id);
+        if (it == channels_.end()) {
+            return;
+        }
+        Channel& channel = it->second;
+        channel.scheduled = false;
+        auto now = Clock::now();
+
+        // Edits first: a reply that outgrew its message hands sections to the new ones
+        std::vector<std::shared_ptr<Reply>> to_edit;
+        to_edit.swap(channel.to_edit);
+        for (const auto& reply : to_edit) {
+            reply->listed = false;
+            if (reply->creating) {
+                continue;  // Picked up once Discord confirms it
+            }
+            if (reply->sections.empty()) {
+                count_call(channel, now);
+                ++stats_.deletes;
+                uint64_t reply_id = reply->id;
+                actions.push_back([this, channel_id, reply_id] { sink_.remove(channel_id, reply_id); });
+                continue;
+            }
+            send_edit(channel, reply, now, actions);
+        }
+
+        // Then new replies, as many sections to a message as fit
+        std::vector<uint64_t> pending;
+        pending.swap(channel.pending);
+        std::vector<Section*> group;
+        ReplyPage page;
+        for (uint64_t id : pending) {
+            auto found = sections_.find(id);
+            if (found == sections_.end() || found->second.reply) {
+                continue;
+            }
+            group.push_back(&found->second);
+
+            Reply probe;
+            probe.merged = group.size() > 1;
+            if (group.size() > 1 && !render(probe, group, page)) {
+                group.pop_back();
+                send_create(channel, group, now, actions);
+                group.assign(1, &found->second);
+            }
+        }
+        if (!group.empty()) {
+            send_create(channel, group, now, actions);
+        }
+
+        prune(now);
+    }
+
+    for (auto& action : actions) {
+        action();
+    }
+}
+
+void ReplyDispatcher::count_call(Channel& channel, Clock::time_point now) {
+    channel.calls.push_back(now);
+    ++channel.total_calls;
+    while (channel.calls.size() > options_.channel_budget * 4) {
+        channel.calls.pop_front();
+    }
+}
+
+void ReplyDispatcher::mark_dirty(Channel& channel, const std::shared_ptr<Reply>& reply) {
+    reply->dirty = true;
+    if (!reply->listed) {
+        reply->listed = true;
+        channel.to_edit.push_back(reply);
+    }
+}
+
+bool ReplyDispatcher::render(const Reply& reply, const std::vector<Section*>& sections, ReplyPage& page) const {
+    page.reply_to = reply.merged || sections.empty() ? 0 : sections.front()->origin.id;
+    page.embeds.assign(1, std::string());
+    for (const Section* section : sections) {
+        append_block(page.embeds, reply.merged ? jump_link(section->origin) + "\n" + section->text : section->text);
+    }
+    while (page.embeds.size() > 1 && page.embeds.back().empty()) {
+        page.embeds.pop_back();
+    }
+
+    size_t text = FOOTER_RESERVE;
+    for (const auto& embed : page.embeds) {
+        text += embed.size();
+    }
+    return page.embeds.size() <= MESSAGE_EMBEDS_MAX && text <= MESSAGE_TEXT_MAX;
+}
+
+std::vector<ReplyDispatcher::Sent> ReplyDispatcher::sent_sections(const std::vector<Section*>& sections) const {
+    std::vector<Sent> sent;
+    sent.reserve(sections.size());
+    for (const Section* section : sections) {
+        sent.push_back({section->origin.id, section->origin.content_hash, text_hash(section->text),
+                        section->source_lang, section->changed_at});
+    }
+    return sent;
+}
+
+void ReplyDispatcher::send_edit(Channel& channel, const std::shared_ptr<Reply>& reply, Clock::time_point now, Actions& actions) {
+    std::vector<Section*> sections;
+    for (uint64_t id : reply->sections) {
+        sections.push_back(&sections_.at(id));
+    }
+
+    // Grown past the limits: the last sections move on to a new reply
+    ReplyPage page;
+    while (!render(*reply, sections, page) && sections.size() > 1) {
+        Section* moved = sections.back();
+        sections.pop_back();
+        reply->sections.pop_back();
+        moved->reply = nullptr;
+        channel.pending.push_back(moved->origin.id);
+    }
+
+    reply->dirty = false;
+    count_call(channel, now);
+    ++stats_.edits;
+
+    std::weak_ptr<ReplyDispatcher> self = weak_from_this();
+    actions.push_back([this, self, reply, page = std::move(page), sent = sent_sections(sections)] {
+        sink_.edit(reply->channel_id, reply->id, page, [self, reply, sent](bool ok) {
+            if (auto dispatcher = self.lock()) {
+                dispatcher->on_edited(reply, sent, ok);
+            }
+        });
+    });
+}
+
+void ReplyDispatcher::send_create(Channel& channel, const std::vector<Section*>& sections, Clock::time_point now, Actions& actions) {
+    auto reply = std::make_shared<Reply>();
+    reply->channel_id = sections.front()->origin.channel_id;
+    reply->merged = sections.size() > 1;
+    reply->creating = true;
+    for (Section* section : sections) {
+        section->reply = reply;
+        reply->sections.push_back(section->origin.id);
+    }
+
+    ReplyPage page;
+    render(*reply, sections, page);
+    count_call(channel, now);
+    ++stats_.created;
+    stats_.sections += sections.size();
+    replies_created.add();
+    sections_posted.add(sections.size());
+
+    std::weak_ptr<ReplyDispatcher> self = weak_from_this();
+    actions.push_back([this, self, reply, page = std::move(page), sent = sent_sections(sections)] {
+        sink_.create(reply->channel_id, page, [self, reply, sent](uint64_t reply_id) {
+            if (auto dispatcher = self.lock()) {
+                dispatcher->on_created(reply, sent, reply_id);
+            }
+        });
+    });
+}
+
+// Record what Discord now shows, for edits and deletions of the originals
+void ReplyDispatcher::confirmed(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, Clock::time_point now) {
+    for (const Sent& section : sent) {
+        reply_lag.observe(now - section.changed_at);
+
+        auto it = sections_.find(section.original_id);
+        if (it == sections_.end() || it->second.reply != reply) {
+            continue;  // Deleted or moved on meanwhile
+        }
+        it->second.failed_creates = 0;
+
+        ReplyRecord record;
+        if (!replies_.find(section.original_id, record)) {
+            record.original_id = section.original_id;
+            record.content_hash = section.content_hash;
+        }
+        record.reply_id = reply->id;
+        record.reply_hash = section.text_hash;
+        record.set_source(section.source_lang);
+        record.shared = reply->merged;
+        replies_.put(record);
+    }
+}
+
+void ReplyDispatcher::on_created(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, uint64_t reply_id) {
+    Actions actions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = Clock::now();
+        reply->creating = false;
+
+        // Not posted: its sections wait for the next flush again, unless they
+        // failed too often, in which case a later edit starts a fresh reply
+        if (reply_id == 0) {
+            Channel& channel = channels_[reply->channel_id];
+            if (reply->listed) {
+                channel.to_edit.erase(std::remove(channel.to_edit.begin(), channel.to_edit.end(), reply),
+                                      channel.to_edit.end());
+                reply->listed = false;
+            }
+
+            std::vector<uint64_t> retried;
+            for (uint64_t id : reply->sections) {
+                auto it = sections_.find(id);
+                if (it == sections_.end() || it->second.reply != reply) {
+                    continue;
+                }
+                if (++it->second.failed_creates > MAX_SEND_RETRIES) {
+                    sections_.erase(it);
+                    continue;
+                }
+                it->second.reply = nullptr;
+                retried.push_back(id);
+            }
+            reply->sections.clear();
+
+            if (!retried.empty()) {
+                channel.pending.insert(channel.pending.begin(), retried.begin(), retried.end());
+                schedule(reply->channel_id, channel, now);
+            }
+            return;
+        }
+
+        reply->id = reply_id;
+        confirmed(reply, sent, now);
+
+        Channel& channel = channels_[reply->channel_id];
+        if (reply->sections.empty()) {
+            count_call(channel, now);
+            ++stats_.deletes;
+            uint64_t channel_id = reply->channel_id;
+            actions.push_back([this, channel_id, reply_id] { sink_.remove(channel_id, reply_id); });
+        } else {
+            if (reply->merged) {
+                retain(reply);
+            }
+            if (reply->dirty) {
+                // Still listed if the flush that would have skipped it hasn't run yet
+                mark_dirty(channel, reply);
+                schedule(reply->channel_id, channel, now);
+            } else {
+                release(reply);
+            }
+        }
+    }
+
+    for (auto& action : actions) {
+        action();
+    }
+}
+
+void ReplyDispatcher::on_edited(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, bool ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    if (ok) {
+        reply->failed_edits = 0;
+        confirmed(reply, sent, now);
+    } else {
+        ++stats_.failed_edits;
+        // Discord still shows the old text; send it again within the channel's budget
+        if (++reply->failed_edits <= MAX_SEND_RETRIES) {
+            Channel& channel = channels_[reply->channel_id];
+            mark_dirty(channel, reply);
+            schedule(reply->channel_id, channel, now);
+        }
+    }
+    if (!reply->dirty) {
+        release(reply);
+    }
+}
+
+// A plain reply is only kept in memory while it has changes under way; the
+// reply index is enough to find it again
+void ReplyDispatcher::release(const std::shared_ptr<Reply>& reply) {
+    if (reply->merged || reply->listed || reply->creating) {
+        return;
+    }
+    for (uint64_t id : reply->sections) {
+        auto it = sections_.find(id);
+        if (it != sections_.end() && it->second.reply == reply) {
+            sections_.erase(it);
+        }
+    }
+}
+
+void ReplyDispatcher::retain(const std::shared_ptr<Reply>& reply) {
+    retained_.push_back(reply);
+    while (retained_.size() > options_.retained_replies) {
+        std::shared_ptr<Reply> oldest = retained_.front();
+        retained_.pop_front();
+        if (oldest->listed || oldest->creating) {
+            // Still changing; look again after the next reply is retained
+            retained_.push_back(oldest);
+            break;
+        }
+        for (uint64_t id : oldest->sections) {
+            auto it = sections_.find(id);
+            if (it != sections_.end() && it->second.reply == oldest) {
+                sections_.erase(it);
+            }
+        }
+    }
+}
+
+void ReplyDispatcher::prune(Clock::time_point now) {
+    if (now - pruned_at_ < std::chrono::minutes(1)) {
+        return;
+    }
+    pruned_at_ = now;
+
+    for (auto it = channels_.begin(); it != channels_.end();) {
+        const Channel& channel = it->second;
+        bool idle = channel.pending.empty() && channel.to_edit.empty() && !channel.scheduled &&
+                    now - channel.last_active >= CHANNEL_IDLE &&
+                    (channel.calls.empty() || now - channel.calls.back() >= CHANNEL_IDLE);
+        it = idle ? channels_.erase(it) : std::next(it);
+    }
+}
+
+void ReplyDispatcher::write_metrics(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+
+    out << "# HELP discord_channel_rest_calls_total Auto-translate REST calls per channel\n"
+        << "# TYPE discord_channel_rest_calls_total counter\n";
+    for (const auto& [id, channel] : channels_) {
+        out << "discord_channel_rest_calls_total{channel=\"" << id << "\"} " << channel.total_calls << "\n";
+    }
+
+    out << "# HELP discord_channel_budget_used Share of a channel's REST budget used in the current period\n"
+        << "# TYPE discord_channel_budget_used gauge\n";
+    for (const auto& [id, channel] : channels_) {
+        size_t recent = std::count_if(channel.calls.begin(), channel.calls.end(), [&](Clock::time_point call) {
+            return now - call < options_.budget_period;
+        });
+        out << "discord_channel_budget_used{channel=\"" << id << "\"} "
+            << static_cast<double>(recent) / options_.channel_budget << "\n";
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reply_index.h"
+
+// One Discord message of auto-translate replies: embed descriptions, and the
+// message it replies to (0 for a merged reply, whose sections link to their
+// originals instead)
+struct ReplyPage {
+    uint64_t reply_to = 0;
+    std::vector<std::string> embeds;
+};
+
+// Where replies go. Calls are made without the dispatcher's lock held, and
+// the callbacks may run on any thread.
+class ReplySink {
+public:
+    virtual ~ReplySink() = default;
+
+    // done(id) with the new message's ID, or 0 if it could not be posted
+    virtual void create(uint64_t channel_id, const ReplyPage& page, std::function<void(uint64_t reply_id)> done) = 0;
+    virtual void edit(uint64_t channel_id, uint64_t reply_id, const ReplyPage& page, std::function<void(bool ok)> done) = 0;
+    virtual void remove(uint64_t channel_id, uint64_t reply_id) = 0;
+};
+
+struct DispatcherOptions {
+    std::chrono::milliseconds window{500};      // How long a busy channel's replies are gathered; 0 sends at once
+    size_t channel_budget = 5;                  // REST calls per channel per budget period before replies wait
+    std::chrono::seconds budget_period{5};
+    size_t retained_replies = 4096;             // Merged replies kept editable after their original changes
+};
+
+DispatcherOptions dispatcher_options_from_config();
+
+struct DispatcherStats {
+    size_t channels = 0;
+    size_t pending = 0;           // Messages whose translations wait for their channel's window
+    uint64_t created = 0;         // Reply messages posted
+    uint64_t sections = 0;        // Original messages those replies answered
+    uint64_t edits = 0;
+    uint64_t failed_edits = 0;    // Edits Discord refused, retried a few times
+    uint64_t deletes = 0;
+    uint64_t deferred = 0;        // Flushes held back because the channel's budget was spent
+    uint64_t unavailable = 0;     // Edits and deletions of merged replies no longer retained
+};
+
+// The message an auto-translate reply answers
+struct ReplyOrigin {
+    uint64_t id;
+    uint64_t channel_id;
+    uint64_t guild_id;
+    uint32_t content_hash;
+};
+
+// Outbound side of auto-translate. Translations are gathered per channel
+// for a short window and posted together: the sections of messages ready
+// in the same window share one reply, with a link back to each original,
+// laid out over as many embeds and messages as Discord's size limits need.
+// Later changes to a posted section (more target languages arriving, the
+// original being edited or deleted) become one edit per window. A channel
+// that has been quiet for a window is answered at once, and one that has
+// used its REST budget waits for it to refill.
+//
+// Replies are recorded in the reply index. Merged replies keep their
+// sections' text in memory so any of them can be edited; the oldest are
+// let go once more than retained_replies are kept. Create it with
+// std::make_shared: timers and REST callbacks hold it weakly.
+class ReplyDispatcher : public std::enable_shared_from_this<ReplyDispatcher> {
+public:
+    ReplyDispatcher(ReplySink& sink, ReplyIndex& replies, DispatcherOptions options);
+    ~ReplyDispatcher();
+
+    ReplyDispatcher(const ReplyDispatcher&) = delete;
+    ReplyDispatcher& operator=(const ReplyDispatcher&) = delete;
+
+    // Show text as the translations of origin, posting or editing its reply
+    void update(const ReplyOrigin& origin, const std::string& source_lang, const std::string& text);
+
+    // Take down the translations of a deleted original. False if it had none.
+    bool remove(uint64_t original_id, uint64_t channel_id);
+
+    DispatcherStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Reply {
+        uint64_t id = 0;
+        uint64_t channel_id = 0;
+        bool merged = false;    // Sections carry links; never turns into a plain reply
+        bool creating = false;
+        bool dirty = false;     // Sections changed since the last create or edit
+        bool listed = false;    // In its channel's list of replies to edit
+        int failed_edits = 0;   // Failures in a row; retries stop past a limit
+        std::vector<uint64_t> sections;  // Original IDs, in order
+    };
+
+    struct Section {
+        ReplyOrigin origin;
+        std::string source_lang;
+        std::string text;
+        std::shared_ptr<Reply> reply;  // Null while waiting for a reply
+        Clock::time_point changed_at;  // For the reply lag
+        int failed_creates = 0;        // Replies that failed to post it, in a row
+    };
+
+    // What was sent for a section, recorded once Discord confirms it
+    struct Sent {
+        uint64_t original_id;
+        uint32_t content_hash;
+        uint32_t text_hash;
+        std::string source_lang;
+        Clock::time_point changed_at;
+    };
+
+    struct Channel {
+        std::vector<uint64_t> pending;  // Sections without a reply, oldest first
+        std::vector<std::shared_ptr<Reply>> to_edit;
+        std::deque<Clock::time_point> calls;  // REST calls made in the last budget period
+        uint64_t total_calls = 0;
+        Clock::time_point last_active;
+        bool scheduled = false;
+    };
+
+    using Actions = std::vector<std::function<void()>>;
+
+    void schedule(uint64_t channel_id, Channel& channel, Clock::time_point now);
+    void flush(uint64_t channel_id);
+    void count_call(Channel& channel, Clock::time_point now);
+    void mark_dirty(Channel& channel, const std::shared_ptr<Reply>& reply);
+    bool render(const Reply& reply, const std::vector<Section*>& sections, ReplyPage& page) const;
+    std::vector<Sent> sent_sections(const std::vector<Section*>& sections) const;
+    void send_edit(Channel& channel, const std::shared_ptr<Reply>& reply, Clock::time_point now, Actions& actions);
+    void send_create(Channel& channel, const std::vector<Section*>& sections, Clock::time_point now, Actions& actions);
+    void confirmed(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, Clock::time_point now);
+    void on_created(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, uint64_t reply_id);
+    void on_edited(const std::shared_ptr<Reply>& reply, const std::vector<Sent>& sent, bool ok);
+    void release(const std::shared_ptr<Reply>& reply);
+    void retain(const std::shared_ptr<Reply>& reply);
+    void prune(Clock::time_point now);
+    void write_metrics(std::ostream& out);
+
+    ReplySink& sink_;
+    ReplyIndex& replies_;
+    const DispatcherOptions options_;
+    uint64_t collector_id_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Section> sections_;
+    std::unordered_map<uint64_t, Channel> channels_;
+    std::deque<std::shared_ptr<Reply>> retained_;  // Merged replies, oldest first
+    Clock::time_point pruned_at_;
+    DispatcherStats stats_;
+};
@@ -0,0 +1,177 @@
+#include "reply_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// Slots looked at to find an entry to evict when the table is full
+static const size_t EVICTION_SCAN = 32;
+
+std::string_view ReplyRecord::source() const {
+    return std::string_view(source_lang, strnlen(source_lang, sizeof(source_lang)));
+}
+
+void ReplyRecord::set_source(std::string_view lang) {
+    std::memset(source_lang, 0, sizeof(source_lang));
+    if (lang.size() <= sizeof(source_lang)) {
+        std::memcpy(source_lang, lang.data(), lang.size());
+    }
+}
+
+uint32_t text_hash(std::string_view text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash;
+}
+
+ReplyIndex::ReplyIndex(size_t capacity, std::chrono::seconds ttl)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      ttl_(static_cast<uint32_t>(std::max<int64_t>(ttl.count(), 1))),
+      epoch_(std::chrono::steady_clock::now()) {
+    // Keep the load factor at or under 3/4 so probe runs stay short
+    size_t slots = 16;
+    while (slots * 3 < capacity_ * 4) {
+        slots *= 2;
+    }
+    slots_.resize(slots);
+    mask_ = slots - 1;
+}
+
+size_t ReplyIndex::home(uint64_t id) const {
+    // Snowflakes share their high bits, so mix before masking
+    id ^= id >> 33;
+    id *= 0xff51afd7ed558ccdULL;
+    id ^= id >> 33;
+    return static_cast<size_t>(id) & mask_;
+}
+
+uint32_t ReplyIndex::now() const {
+    auto elapsed = std::chrono::steady_clock::now() - epoch_;
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(elapsed).count());
+}
+
+bool ReplyIndex::expired(const ReplyRecord& record, uint32_t now) const {
+    return now - record.touched >= ttl_;
+}
+
+size_t ReplyIndex::locate(uint64_t id) const {
+    for (size_t slot = home(id);; slot = (slot + 1) & mask_) {
+        if (slots_[slot].original_id == id) {
+            return slot;
+        }
+        if (slots_[slot].original_id == 0) {
+            return std::string::npos;
+        }
+    }
+}
+
+void ReplyIndex::remove_at(size_t slot) {
+    // Shift later entries of the probe run back into the hole, so lookups
+    // never need tombstones
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask_; slots_[next].original_id != 0; next = (next + 1) & mask_) {
+        size_t distance = (next - home(slots_[next].original_id)) & mask_;
+        if (distance >= ((next - hole) & mask_)) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = ReplyRecord();
+    --size_;
+}
+
+void ReplyIndex::evict_one(uint32_t now) {
+    size_t victim = std::string::npos;
+    size_t scanned = 0;
+    size_t limit = std::min(EVICTION_SCAN, size_);
+    for (size_t slot = hand_; scanned < limit; slot = (slot + 1) & mask_) {
+        const ReplyRecord& record = slots_[slot];
+        if (record.original_id == 0) {
+            continue;
+        }
+        ++scanned;
+        if (expired(record, now)) {
+            victim = slot;
+            break;
+        }
+        if (victim == std::string::npos || now - record.touched > now - slots_[victim].touched) {
+            victim = slot;
+        }
+    }
+
+    if (expired(slots_[victim], now)) {
+        ++expirations_;
+    } else {
+        ++evictions_;
+    }
+    remove_at(victim);
+    hand_ = (victim + 1) & mask_;
+}
+
+void ReplyIndex::put(const ReplyRecord& record) {
+    if (record.original_id == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t stamp = now();
+
+    size_t slot = locate(record.original_id);
+    if (slot == std::string::npos) {
+        if (size_ >= capacity_) {
+            evict_one(stamp);
+        }
+        slot = home(record.original_id);
+        while (slots_[slot].original_id != 0) {
+            slot = (slot + 1) & mask_;
+        }
+        ++size_;
+    }
+
+    slots_[slot] = record;
+    slots_[slot].touched = stamp;
+}
+
+bool ReplyIndex::find(uint64_t original_id, ReplyRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t slot = original_id ? locate(original_id) : std::string::npos;
+    if (slot == std::string::npos) {
+        return false;
+    }
+    if (expired(slots_[slot], now())) {
+        ++expirations_;
+        remove_at(slot);
+        return false;
+    }
+    record = slots_[slot];
+    return true;
+}
+
+bool ReplyIndex::erase(uint64_t original_id, ReplyRecord* record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t slot = original_id ? locate(original_id) : std::string::npos;
+    if (slot == std::string::npos) {
+        return false;
+    }
+    bool live = !expired(slots_[slot], now());
+    if (live && record) {
+        *record = slots_[slot];
+    }
+    if (!live) {
+        ++expirations_;
+    }
+    remove_at(slot);
+    return live;
+}
+
+ReplyIndexStats ReplyIndex::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ReplyIndexStats stats;
+    stats.entries = size_;
+    stats.capacity = capacity_;
+    stats.evictions = evictions_;
+    stats.expirations = expirations_;
+    return stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// What is kept about an auto-translate reply, so edits and deletions of the
+// original message can be applied to it. 40 bytes per entry.
+struct ReplyRecord {
+    uint64_t original_id = 0;  // 0 marks an empty slot
+    uint64_t reply_id = 0;
+    uint32_t content_hash = 0;  // Of the original's content, to ignore updates that leave it alone
+    uint32_t reply_hash = 0;    // Of the reply's description, to skip edits that change nothing
+    uint32_t revision = 0;      // Bumped per edit, so a slow translation can't overwrite a newer one
+    uint32_t touched = 0;       // Set by the index
+    char source_lang[7] = {};   // Source language of the original, if known
+    bool shared = false;        // The reply also answers other messages
+
+    std::string_view source() const;
+    void set_source(std::string_view lang);
+};
+
+struct ReplyIndexStats {
+    size_t entries = 0;
+    size_t capacity = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+};
+
+// Bounded map from original message id to its auto-translate reply. An
+// open-addressing table with linear probing, sized up front so it never
+// allocates after construction. Entries expire ttl after they were last
+// written; when the table is full, an expired entry or else the oldest of a
+// few nearby ones makes room.
+class ReplyIndex {
+public:
+    ReplyIndex(size_t capacity, std::chrono::seconds ttl);
+
+    // Insert or replace the record for record.original_id
+    void put(const ReplyRecord& record);
+
+    // Copy out the live record for original_id
+    bool find(uint64_t original_id, ReplyRecord& record);
+
+    // Remove the record for original_id, copying it out first if record is set
+    bool erase(uint64_t original_id, ReplyRecord* record = nullptr);
+
+    ReplyIndexStats stats() const;
+
+private:
+    size_t home(uint64_t id) const;
+    uint32_t now() const;
+    bool expired(const ReplyRecord& record, uint32_t now) const;
+    size_t locate(uint64_t id) const;
+    void remove_at(size_t slot);
+    void evict_one(uint32_t now);
+
+    mutable std::mutex mutex_;
+    std::vector<ReplyRecord> slots_;
+    size_t mask_;
+    size_t capacity_;
+    uint32_t ttl_;
+    std::chrono::steady_clock::time_point epoch_;
+    size_t size_ = 0;
+    size_t hand_ = 0;
+    uint64_t evictions_ = 0;
+    uint64_t expirations_ = 0;
+};
+
+// 32-bit FNV-1a hash for ReplyRecord's content and reply hashes
+uint32_t text_hash(std::string_view text);
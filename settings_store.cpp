@@ -0,0 +1,448 @@
+#include "settings_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using json = nlohmann::json;
+
+static const char BINARY_MAGIC[4] = {'T', 'S', 'S', '1'};
+
+// Header of the binary copy; entries follow, channels first:
+// u64 id, u8 language count, then per language u8 length and the code
+struct BinaryHeader {
+    char magic[4];
+    uint32_t channels;
+    uint32_t servers;
+    uint32_t unused;
+    uint64_t source_size;      // Of the main file the copy was made from
+    int64_t source_mtime_ns;
+};
+
+Settings::Settings() {
+    auto empty = std::make_shared<const Shard>();
+    channels.fill(empty);
+    servers.fill(empty);
+}
+
+const Settings::Langs* Settings::find(const Table& table, uint64_t id) {
+    const Shard& shard = *table[shard_of(id)];
+    auto it = shard.find(id);
+    return it == shard.end() ? nullptr : &it->second;
+}
+
+size_t Settings::count(const Table& table) {
+    size_t total = 0;
+    for (const auto& shard : table) {
+        total += shard->size();
+    }
+    return total;
+}
+
+const Settings::Langs* Settings::targets_for(uint64_t channel_id, uint64_t guild_id) const {
+    if (const Langs* langs = find(channels, channel_id)) {
+        return langs;
+    }
+    return guild_id ? find(servers, guild_id) : nullptr;
+}
+
+SettingsStore::SettingsStore(std::string path)
+    : path_(std::move(path)), log_path_(path_.empty() ? "" : path_ + ".log"),
+      binary_path_(path_.empty() ? "" : path_ + ".bin"), current_(std::make_shared<const Settings>()) {}
+
+SettingsStore::~SettingsStore() {
+    if (log_) {
+        std::fclose(log_);
+    }
+}
+
+// Language lists are stored as arrays; older files may hold a single string
+static std::vector<std::string> read_langs(const json& value) {
+    std::vector<std::string> langs;
+    if (value.is_string()) {
+        langs.push_back(value.get<std::string>());
+    } else if (value.is_array()) {
+        for (const auto& lang : value) {
+            if (lang.is_string()) {
+                langs.push_back(lang.get<std::string>());
+            }
+        }
+    }
+    return langs;
+}
+
+// Writable copy of a table, used while loading
+using ShardArray = std::array<Settings::Shard, std::tuple_size<Settings::Table>::value>;
+
+static void set_entry(ShardArray& shards, uint64_t id, std::vector<std::string> langs) {
+    Settings::Shard& shard = shards[Settings::shard_of(id)];
+    if (langs.empty()) {
+        shard.erase(id);
+    } else {
+        shard[id] = std::move(langs);
+    }
+}
+
+static void read_section(const json& data, const char* name, ShardArray& out) {
+    auto it = data.find(name);
+    if (it == data.end() || !it->is_object()) {
+        return;
+    }
+
+    for (const auto& [key, value] : it->items()) {
+        set_entry(out, std::stoull(key), read_langs(value));
+    }
+}
+
+// Size and modification time of the main file, which the binary copy must match
+static bool file_stamp(const std::string& path, uint64_t& size, int64_t& mtime_ns) {
+    struct stat info;
+    if (path.empty() || stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    mtime_ns = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+// Parse the binary copy's entries, checking every length against the mapping
+static bool read_binary_entries(const char* data, size_t size, ShardArray& channels, ShardArray& servers) {
+    BinaryHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    const char* p = data + sizeof(header);
+    const char* end = data + size;
+
+    uint64_t total = uint64_t(header.channels) + header.servers;
+    for (uint64_t i = 0; i < total; ++i) {
+        uint64_t id;
+        if (end - p < static_cast<ptrdiff_t>(sizeof(id) + 1)) {
+            return false;
+        }
+        std::memcpy(&id, p, sizeof(id));
+        p += sizeof(id);
+        size_t count = static_cast<unsigned char>(*p++);
+
+        std::vector<std::string> langs;
+        langs.reserve(count);
+        for (size_t j = 0; j < count; ++j) {
+            if (p == end || end - p - 1 < static_cast<unsigned char>(*p)) {
+                return false;
+            }
+            size_t length = static_cast<unsigned char>(*p++);
+            langs.emplace_back(p, length);
+            p += length;
+        }
+        set_entry(i < header.channels ? channels : servers, id, std::move(langs));
+    }
+    return p == end;
+}
+
+static bool read_binary(const std::string& path, uint64_t source_size, int64_t source_mtime_ns,
+                        ShardArray& channels, ShardArray& servers) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(BinaryHeader);
+    void* mapped = ok ? mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    const char* data = static_cast<const char*>(mapped);
+    BinaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    ok = std::equal(header.magic, header.magic + sizeof(header.magic), BINARY_MAGIC) &&
+         header.source_size == source_size && header.source_mtime_ns == source_mtime_ns;
+    if (ok) {
+        madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+        ok = read_binary_entries(data, info.st_size, channels, servers);
+        if (!ok) {
+            // Half-read entries must not mix with the JSON read instead
+            channels = ShardArray();
+            servers = ShardArray();
+            std::cerr << "Ignoring damaged settings snapshot " << path << std::endl;
+        }
+    }
+    munmap(mapped, info.st_size);
+    return ok;
+}
+
+static const Settings::Shard& shard_ref(const Settings::Shard& shard) {
+    return shard;
+}
+
+static const Settings::Shard& shard_ref(const std::shared_ptr<const Settings::Shard>& shard) {
+    return *shard;
+}
+
+template <typename Shards>
+static void write_binary_entries(std::string& out, const Shards& shards) {
+    for (const auto& slot : shards) {
+        for (const auto& [id, langs] : shard_ref(slot)) {
+            out.append(reinterpret_cast<const char*>(&id), sizeof(id));
+            size_t count = std::min<size_t>(langs.size(), 255);
+            out += static_cast<char>(count);
+            for (size_t i = 0; i < count; ++i) {
+                size_t length = std::min<size_t>(langs[i].size(), 255);
+                out += static_cast<char>(length);
+                out.append(langs[i], 0, length);
+            }
+        }
+    }
+}
+
+// Write the binary copy of a main file through a temporary file and a rename
+template <typename Shards>
+static bool write_binary(const std::string& path, const Shards& channels, const Shards& servers,
+                         uint64_t source_size, int64_t source_mtime_ns) {
+    BinaryHeader header = {};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    for (const auto& slot : channels) {
+        header.channels += shard_ref(slot).size();
+    }
+    for (const auto& slot : servers) {
+        header.servers += shard_ref(slot).size();
+    }
+    header.source_size = source_size;
+    header.source_mtime_ns = source_mtime_ns;
+
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_binary_entries(out, channels);
+    write_binary_entries(out, servers);
+
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), out.size());
+        if (!file.good()) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+static void publish(ShardArray& shards, Settings::Table& table) {
+    for (size_t i = 0; i < shards.size(); ++i) {
+        table[i] = std::make_shared<const Settings::Shard>(std::move(shards[i]));
+    }
+}
+
+void SettingsStore::apply(Settings& settings, Scope scope, uint64_t id, std::vector<std::string> langs) {
+    Settings::Table& table = scope == Scope::Channel ? settings.channels : settings.servers;
+    auto& slot = table[Settings::shard_of(id)];
+
+    // Copy only the shard being changed; the rest stay shared with older snapshots
+    auto shard = std::make_shared<Settings::Shard>(*slot);
+    if (langs.empty()) {
+        shard->erase(id);
+    } else {
+        (*shard)[id] = std::move(langs);
+    }
+    slot = std::move(shard);
+}
+
+bool SettingsStore::load() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    ShardArray channels;
+    ShardArray servers;
+
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    bool stamped = file_stamp(path_, size, mtime_ns);
+    if (!stamped || !read_binary(binary_path_, size, mtime_ns, channels, servers)) {
+        std::ifstream file(path_);
+        if (file.is_open()) {
+            try {
+                json data = json::parse(file);
+                read_section(data, "auto_translate_channels", channels);
+                read_section(data, "auto_translate_servers", servers);
+            } catch (const std::exception& e) {
+                std::cerr << "Error loading settings: " << e.what() << std::endl;
+                return false;
+            }
+
+            // So the next start can skip the JSON
+            if (stamped && !write_binary(binary_path_, channels, servers, size, mtime_ns)) {
+                std::cerr << "Error writing settings snapshot " << binary_path_ << std::endl;
+            }
+        }
+    }
+
+    // Replay changes made since the last compaction. A torn final line from
+    // a crash mid-append is skipped.
+    log_entries_ = 0;
+    std::ifstream log(log_path_);
+    std::string line;
+    while (std::getline(log, line)) {
+        try {
+            json change = json::parse(line);
+            ShardArray& shards = change.at("scope").get<std::string>() == "server" ? servers : channels;
+            set_entry(shards, std::stoull(change.at("id").get<std::string>()), read_langs(change.at("langs")));
+            ++log_entries_;
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping settings log entry: " << e.what() << std::endl;
+        }
+    }
+
+    auto settings = std::make_shared<Settings>();
+    publish(channels, settings->channels);
+    publish(servers, settings->servers);
+    std::atomic_store(&current_, std::shared_ptr<const Settings>(std::move(settings)));
+    return true;
+}
+
+bool SettingsStore::open_log() {
+    if (!log_ && !log_path_.empty()) {
+        log_ = std::fopen(log_path_.c_str(), "a");
+        if (!log_) {
+            std::cerr << "Error opening settings log " << log_path_ << std::endl;
+        }
+    }
+    return log_ != nullptr;
+}
+
+void SettingsStore::update(Scope scope, uint64_t id, std::vector<std::string> langs, bool notify) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (notify && listener_) {
+        listener_({scope, id, langs});
+    }
+
+    json change = {
+        {"scope", scope == Scope::Server ? "server" : "channel"},
+        {"id", std::to_string(id)},
+        {"langs", langs},
+    };
+
+    auto next = std::make_shared<Settings>(*std::atomic_load(&current_));
+    apply(*next, scope, id, std::move(langs));
+    std::atomic_store(&current_, std::shared_ptr<const Settings>(std::move(next)));
+
+    if (open_log()) {
+        std::string line = change.dump() + "\n";
+        std::fwrite(line.data(), 1, line.size(), log_);
+        std::fflush(log_);
+        ++log_entries_;
+    }
+}
+
+void SettingsStore::set_channel(uint64_t channel_id, std::vector<std::string> langs) {
+    update(Scope::Channel, channel_id, std::move(langs), true);
+}
+
+void SettingsStore::set_server(uint64_t server_id, std::vector<std::string> langs) {
+    update(Scope::Server, server_id, std::move(langs), true);
+}
+
+void SettingsStore::apply_shared(const SettingsChange& change) {
+    update(change.scope, change.id, change.langs, false);
+}
+
+void SettingsStore::replace(const std::vector<SettingsChange>& entries) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    ShardArray channels;
+    ShardArray servers;
+    for (const auto& entry : entries) {
+        set_entry(entry.scope == Scope::Server ? servers : channels, entry.id, entry.langs);
+    }
+
+    auto settings = std::make_shared<Settings>();
+    publish(channels, settings->channels);
+    publish(servers, settings->servers);
+    std::atomic_store(&current_, std::shared_ptr<const Settings>(std::move(settings)));
+}
+
+std::vector<SettingsChange> SettingsStore::entries() const {
+    std::shared_ptr<const Settings> settings = snapshot();
+    std::vector<SettingsChange> entries;
+    for (const auto& shard : settings->channels) {
+        for (const auto& [channel_id, langs] : *shard) {
+            entries.push_back({Scope::Channel, channel_id, langs});
+        }
+    }
+    for (const auto& shard : settings->servers) {
+        for (const auto& [server_id, langs] : *shard) {
+            entries.push_back({Scope::Server, server_id, langs});
+        }
+    }
+    return entries;
+}
+
+size_t SettingsStore::log_entries() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return log_entries_;
+}
+
+bool SettingsStore::compact() {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (log_entries_ == 0 || path_.empty()) {
+        return true;
+    }
+
+    std::shared_ptr<const Settings> settings = std::atomic_load(&current_);
+
+    json data;
+    data["auto_translate_channels"] = json::object();
+    data["auto_translate_servers"] = json::object();
+    for (const auto& shard : settings->channels) {
+        for (const auto& [channel_id, langs] : *shard) {
+            data["auto_translate_channels"][std::to_string(channel_id)] = langs;
+        }
+    }
+    for (const auto& shard : settings->servers) {
+        for (const auto& [server_id, langs] : *shard) {
+            data["auto_translate_servers"][std::to_string(server_id)] = langs;
+        }
+    }
+
+    std::string tmp_path = path_ + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error writing settings to " << tmp_path << std::endl;
+            return false;
+        }
+        out << data.dump(2);
+        if (!out.good()) {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+        std::cerr << "Error replacing " << path_ << std::endl;
+        return false;
+    }
+
+    // A stale binary copy is ignored on load, so failing here only costs startup time
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    if (!file_stamp(path_, size, mtime_ns) ||
+        !write_binary(binary_path_, settings->channels, settings->servers, size, mtime_ns)) {
+        std::cerr << "Error writing settings snapshot " << binary_path_ << std::endl;
+    }
+
+    // Every logged change is now in the main file. Replaying them again after
+    // a crash before this point would be harmless, as each entry is absolute.
+    if (log_) {
+        std::fclose(log_);
+    }
+    log_ = std::fopen(log_path_.c_str(), "w");
+    log_entries_ = 0;
+    return true;
+}
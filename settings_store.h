@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Auto-translate target languages per channel and per server. Entries are
+// split over shards that snapshots share, so a change only copies one shard.
+struct Settings {
+    using Langs = std::vector<std::string>;
+    using Shard = std::unordered_map<uint64_t, Langs>;
+    using Table = std::array<std::shared_ptr<const Shard>, 64>;
+
+    Table channels;
+    Table servers;
+
+    Settings();
+
+    static size_t shard_of(uint64_t id) { return (id * 0x9E3779B97F4A7C15ull) >> 58; }
+    static const Langs* find(const Table& table, uint64_t id);
+    static size_t count(const Table& table);
+
+    // Targets for a message: the channel's list, else the server's, else nullptr
+    const Langs* targets_for(uint64_t channel_id, uint64_t guild_id) const;
+};
+
+enum class SettingsScope { Channel, Server };
+
+// One channel's or server's target languages; an empty list removes the entry
+struct SettingsChange {
+    SettingsScope scope;
+    uint64_t id;
+    std::vector<std::string> langs;
+};
+
+// Settings held in an immutable snapshot that readers load without locking;
+// writers copy it, apply their change and publish the copy. Changes are
+// appended to "<path>.log" as they happen and folded into the main file by
+// compact(), which rewrites it through a temporary file and a rename. With an
+// empty path nothing is persisted.
+//
+// A binary copy of the main file, "<path>.bin", is kept next to it and read
+// through mmap at startup instead of parsing the JSON. It records the main
+// file's size and modification time and is ignored once they no longer
+// match, so a hand-edited main file still wins.
+class SettingsStore {
+public:
+    using Scope = SettingsScope;
+    using ChangeListener = std::function<void(const SettingsChange& change)>;
+
+    explicit SettingsStore(std::string path);
+    ~SettingsStore();
+
+    SettingsStore(const SettingsStore&) = delete;
+    SettingsStore& operator=(const SettingsStore&) = delete;
+
+    // Read the main file, from its binary copy when that is current, and
+    // replay the change log on top of it
+    bool load();
+
+    std::shared_ptr<const Settings> snapshot() const { return std::atomic_load(&current_); }
+
+    // An empty list removes the entry
+    void set_channel(uint64_t channel_id, std::vector<std::string> langs);
+    void set_server(uint64_t server_id, std::vector<std::string> langs);
+
+    // Called under the write lock after every set_channel or set_server, in
+    // the order the changes were made. Set it before the store is shared.
+    void set_listener(ChangeListener listener) { listener_ = std::move(listener); }
+
+    // Apply a change made by another process, without telling the listener
+    void apply_shared(const SettingsChange& change);
+
+    // Replace every entry with the given ones, e.g. the cluster's settings
+    // on connecting to the coordinator. Nothing is logged.
+    void replace(const std::vector<SettingsChange>& entries);
+
+    // Every entry of the current snapshot
+    std::vector<SettingsChange> entries() const;
+
+    // Rewrite the main file from the current snapshot and truncate the log.
+    // Does nothing if the log is empty.
+    bool compact();
+
+    size_t log_entries() const;
+
+private:
+    static void apply(Settings& settings, Scope scope, uint64_t id, std::vector<std::string> langs);
+    void update(Scope scope, uint64_t id, std::vector<std::string> langs, bool notify);
+    bool open_log();
+
+    const std::string path_;
+    const std::string log_path_;
+    const std::string binary_path_;
+
+    std::shared_ptr<const Settings> current_;
+    ChangeListener listener_;
+
+    mutable std::mutex write_mutex_;  // Serializes writers, the log and compaction
+    FILE* log_ = nullptr;
+    size_t log_entries_ = 0;
+};
@@ -0,0 +1,65 @@
+#include "single_flight.h"
+
+#include "metrics.h"
+
+static Counter requests_saved("translator_single_flight_saved_total",
+                              "Requests answered by an identical request already in flight");
+
+SingleFlightBackend::SingleFlightBackend(std::unique_ptr<TranslationBackend> inner) : inner_(std::move(inner)) {}
+
+std::string SingleFlightBackend::key_for(const TranslationRequest& request) {
+    return request.source_lang + '\x1f' + request.target_lang + '\x1f' + request.text;
+}
+
+void SingleFlightBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                          DoneFunction on_done) {
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+
+    // Requests this call sends itself; the rest ride along on another call's
+    std::vector<size_t> leading;
+    std::vector<std::string> leading_keys;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            std::string key = key_for(requests[i]);
+            auto it = calls_.find(key);
+            if (it != calls_.end()) {
+                it->second.push_back({pending, i});
+                continue;
+            }
+
+            calls_.emplace(key, std::vector<Follower>());
+            leading.push_back(i);
+            leading_keys.push_back(std::move(key));
+        }
+    }
+
+    if (leading.empty()) {
+        return;
+    }
+
+    std::vector<TranslationRequest> batch;
+    batch.reserve(leading.size());
+    for (size_t i : leading) {
+        batch.push_back(std::move(requests[i]));
+    }
+
+    inner_->translate_async(std::move(batch), [this, pending, leading = std::move(leading),
+                                               leading_keys = std::move(leading_keys)](size_t i, TranslationResult& result) {
+        std::vector<Follower> followers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = calls_.find(leading_keys[i]);
+            followers.swap(it->second);
+            calls_.erase(it);
+        }
+
+        for (const auto& follower : followers) {
+            TranslationResult copy = result;
+            saved_.fetch_add(1, std::memory_order_relaxed);
+            requests_saved.add();
+            follower.pending->complete(follower.index, copy);
+        }
+        pending->complete(leading[i], result);
+    });
+}
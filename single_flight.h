@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "translation_backend.h"
+
+// Backend wrapper that collapses identical concurrent requests. While a
+// (text, source, target) request is in flight, other callers asking for the
+// same thing are completed with its result instead of sending their own.
+class SingleFlightBackend : public TranslationBackend {
+public:
+    explicit SingleFlightBackend(std::unique_ptr<TranslationBackend> inner);
+
+    const char* name() const override { return inner_->name(); }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+    void warm_up(WarmUpFunction on_done) override { inner_->warm_up(std::move(on_done)); }
+
+    // Requests answered by another caller's in-flight request
+    uint64_t saved() const { return saved_.load(std::memory_order_relaxed); }
+
+private:
+    // A caller's request waiting on one already in flight
+    struct Follower {
+        std::shared_ptr<PendingRequests> pending;
+        size_t index;
+    };
+
+    static std::string key_for(const TranslationRequest& request);
+
+    std::unique_ptr<TranslationBackend> inner_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::vector<Follower>> calls_;  // Keyed by request
+    std::atomic<uint64_t> saved_{0};
+};
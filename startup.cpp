@@ -0,0 +1,59 @@
+#include "startup.h"
+
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "metrics.h"
+
+static const std::chrono::steady_clock::time_point process_start = std::chrono::steady_clock::now();
+
+namespace {
+
+struct Phase {
+    const char* name;
+    double seconds;
+};
+
+struct Timeline {
+    std::mutex mutex;
+    std::vector<Phase> phases;
+
+    Timeline() {
+        add_metrics_collector([this](std::ostream& out) {
+            std::lock_guard<std::mutex> lock(mutex);
+            out << "# HELP startup_phase_seconds Seconds from process start until each startup phase was reached\n"
+                << "# TYPE startup_phase_seconds gauge\n";
+            for (const Phase& phase : phases) {
+                out << "startup_phase_seconds{phase=\"" << phase.name << "\"} " << phase.seconds << "\n";
+            }
+        });
+    }
+};
+
+}  // namespace
+
+static Timeline& timeline() {
+    static Timeline* instance = new Timeline();  // Never destroyed, so late marks stay safe
+    return *instance;
+}
+
+std::chrono::steady_clock::duration since_process_start() {
+    return std::chrono::steady_clock::now() - process_start;
+}
+
+void mark_startup(const char* phase) {
+    double seconds = std::chrono::duration<double>(since_process_start()).count();
+    Timeline& line = timeline();
+    {
+        std::lock_guard<std::mutex> lock(line.mutex);
+        for (const Phase& seen : line.phases) {
+            if (std::strcmp(seen.name, phase) == 0) {
+                return;
+            }
+        }
+        line.phases.push_back({phase, seconds});
+    }
+    std::cout << "Startup: " << phase << " after " << static_cast<long>(seconds * 1000) << " ms" << std::endl;
+}
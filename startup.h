@@ -0,0 +1,12 @@
+#pragma once
+
+#include <chrono>
+
+// Time since the process started, measured from static initialization
+std::chrono::steady_clock::duration since_process_start();
+
+// Record that a startup phase was reached, e.g. "gateway_ready". Only the
+// first call for each phase counts; it is logged and exported as
+// startup_phase_seconds{phase="..."}. Later calls only take a short lock,
+// so a phase like "first_translation" can be marked on every translation.
+void mark_startup(const char* phase);
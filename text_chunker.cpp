@@ -0,0 +1,316 @@
+#include "text_chunker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "event_loop.h"
+#include "metrics.h"
+
+static Counter chunked_texts("translator_chunked_texts_total", "Texts split into several upstream requests");
+static Counter chunks_sent("translator_chunks_total", "Chunks sent upstream for split texts");
+
+static const char* const FENCE = "```";
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static void add_chunk(std::vector<TextChunk>& chunks, std::string text, bool translate) {
+    if (text.empty()) {
+        return;
+    }
+    // Neighbouring verbatim pieces are merged; translatable ones keep their size limit
+    if (!translate && !chunks.empty() && !chunks.back().translate) {
+        chunks.back().text += text;
+        return;
+    }
+    chunks.push_back({std::move(text), translate});
+}
+
+namespace {
+
+// Cuts inside `inline code` would hand upstream half a span
+class InlineCode {
+public:
+    InlineCode(const std::string& text, size_t begin, size_t end) {
+        size_t open = text.find('`', begin);
+        while (open < end) {
+            size_t close = text.find('`', open + 1);
+            if (close >= end) {
+                break;
+            }
+            spans_.emplace_back(open, close);
+            open = text.find('`', close + 1);
+        }
+    }
+
+    bool contains(size_t pos) const {
+        for (const auto& [open, close] : spans_) {
+            if (pos > open && pos <= close) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<std::pair<size_t, size_t>> spans_;
+};
+
+}  // namespace
+
+// Last position in (min, limit] where a separator starts, or npos
+static size_t last_break(const std::string& text, const char* separator, size_t min, size_t limit,
+                         const InlineCode& code) {
+    size_t at = text.rfind(separator, limit);
+    while (at != std::string::npos && at > min) {
+        if (!code.contains(at)) {
+            return at;
+        }
+        if (at == 0) {
+            break;
+        }
+        at = text.rfind(separator, at - 1);
+    }
+    return std::string::npos;
+}
+
+// True if a sentence ends just before at
+static bool is_sentence_end(const std::string& text, size_t at) {
+    static const char* const WIDE_STOPS[] = {"\xE3\x80\x82", "\xEF\xBC\x81", "\xEF\xBC\x9F"};  // 。！？
+
+    char before = text[at - 1];
+    if ((before == '.' || before == '!' || before == '?') && at < text.size() && is_space(text[at])) {
+        return true;
+    }
+    if (at >= 3) {
+        for (const char* stop : WIDE_STOPS) {
+            if (text.compare(at - 3, 3, stop) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Last sentence end in (min, limit]: the position just after the punctuation
+static size_t last_sentence_end(const std::string& text, size_t min, size_t limit, const InlineCode& code) {
+    for (size_t at = limit; at > min; --at) {
+        if (!code.contains(at) && is_sentence_end(text, at)) {
+            return at;
+        }
+    }
+    return std::string::npos;
+}
+
+// Split the prose in text[begin, end) into chunks of at most max_chars
+static void split_prose(const std::string& text, size_t begin, size_t end, size_t max_chars,
+                        std::vector<TextChunk>& chunks) {
+    InlineCode code(text, begin, end);
+    size_t pos = begin;
+
+    while (pos < end) {
+        // Whitespace around chunks is kept out of translation, where it would be trimmed
+        size_t start = pos;
+        while (pos < end && is_space(text[pos])) {
+            ++pos;
+        }
+        add_chunk(chunks, text.substr(start, pos - start), false);
+        if (pos == end) {
+            break;
+        }
+
+        size_t cut = end;
+        if (end - pos > max_chars) {
+            size_t limit = pos + max_chars;
+            // Prefer natural breaks, but not ones that would leave a tiny chunk
+            size_t min = pos + max_chars / 4;
+
+            cut = last_break(text, "\n\n", min, limit, code);
+            if (cut == std::string::npos) {
+                cut = last_break(text, "\n", min, limit, code);
+            }
+            if (cut == std::string::npos) {
+                cut = last_sentence_end(text, min, limit, code);
+            }
+            if (cut == std::string::npos) {
+                cut = last_break(text, " ", pos, limit, code);
+            }
+            if (cut == std::string::npos) {
+                // No break at all: cut at a character boundary
+                cut = limit;
+                while (cut > pos + 1 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) {
+                    --cut;
+                }
+            }
+        }
+
+        size_t piece_end = cut;
+        while (piece_end > pos && is_space(text[piece_end - 1])) {
+            --piece_end;
+        }
+        add_chunk(chunks, text.substr(pos, piece_end - pos), true);
+        add_chunk(chunks, text.substr(piece_end, cut - piece_end), false);
+        pos = cut;
+    }
+}
+
+// Split the prose in text[begin, end) at every line break and sentence end
+static void split_prose_sentences(const std::string& text, size_t begin, size_t end, std::vector<TextChunk>& chunks) {
+    InlineCode code(text, begin, end);
+    size_t pos = begin;
+
+    while (pos < end) {
+        size_t start = pos;
+        while (pos < end && is_space(text[pos])) {
+            ++pos;
+        }
+        add_chunk(chunks, text.substr(start, pos - start), false);
+        if (pos == end) {
+            break;
+        }
+
+        size_t cut = pos + 1;
+        while (cut < end && (code.contains(cut) || (text[cut] != '\n' && !is_sentence_end(text, cut)))) {
+            ++cut;
+        }
+
+        size_t piece_end = cut;
+        while (piece_end > pos && is_space(text[piece_end - 1])) {
+            --piece_end;
+        }
+        add_chunk(chunks, text.substr(pos, piece_end - pos), true);
+        add_chunk(chunks, text.substr(piece_end, cut - piece_end), false);
+        pos = cut;
+    }
+}
+
+// Run split on the prose between fenced code blocks, which become verbatim chunks
+template <typename SplitProse>
+static std::vector<TextChunk> split_around_code(const std::string& text, SplitProse split) {
+    std::vector<TextChunk> chunks;
+    size_t pos = 0;
+
+    while (pos < text.size()) {
+        size_t open = text.find(FENCE, pos);
+        size_t close = open == std::string::npos ? std::string::npos : text.find(FENCE, open + 3);
+        if (close == std::string::npos) {
+            // No complete code block left
+            split(pos, text.size(), chunks);
+            break;
+        }
+
+        split(pos, open, chunks);
+        add_chunk(chunks, text.substr(open, close + 3 - open), false);
+        pos = close + 3;
+    }
+
+    return chunks;
+}
+
+std::vector<TextChunk> split_into_chunks(const std::string& text, size_t max_chars) {
+    max_chars = std::max<size_t>(max_chars, 16);
+    return split_around_code(text, [&](size_t begin, size_t end, std::vector<TextChunk>& chunks) {
+        split_prose(text, begin, end, max_chars, chunks);
+    });
+}
+
+std::vector<TextChunk> split_sentences(const std::string& text) {
+    return split_around_code(text, [&](size_t begin, size_t end, std::vector<TextChunk>& chunks) {
+        split_prose_sentences(text, begin, end, chunks);
+    });
+}
+
+ChunkingBackend::ChunkingBackend(std::unique_ptr<TranslationBackend> inner, size_t max_chars)
+    : inner_(std::move(inner)), max_chars_(max_chars) {}
+
+void ChunkingBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                      DoneFunction on_done) {
+    // One split text being put back together
+    struct Assembly {
+        size_t index;
+        std::vector<TextChunk> chunks;
+        size_t remaining = 0;
+        TranslationResult result;
+    };
+
+    // Where each upstream request's result goes: straight to the caller, or into a chunk
+    struct Slot {
+        size_t index;
+        std::shared_ptr<Assembly> assembly;
+        size_t chunk = 0;
+    };
+
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+    auto slots = std::make_shared<std::vector<Slot>>();
+    std::vector<TranslationRequest> upstream;
+    upstream.reserve(requests.size());
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        TranslationRequest& request = requests[i];
+        bool simple = request.text.size() <= max_chars_ && request.text.find(FENCE) == std::string::npos;
+
+        std::vector<TextChunk> chunks;
+        if (!simple) {
+            chunks = split_into_chunks(request.text, max_chars_);
+            simple = chunks.size() == 1 && chunks[0].translate;
+        }
+        if (simple) {
+            slots->push_back({i, nullptr});
+            upstream.push_back(std::move(request));
+            continue;
+        }
+
+        auto assembly = std::make_shared<Assembly>();
+        assembly->index = i;
+        assembly->chunks = std::move(chunks);
+        assembly->result.ok = true;
+        assembly->result.status = 200;
+
+        for (size_t k = 0; k < assembly->chunks.size(); ++k) {
+            if (assembly->chunks[k].translate) {
+                slots->push_back({i, assembly, k});
+                upstream.push_back({assembly->chunks[k].text, request.source_lang, request.target_lang});
+                ++assembly->remaining;
+            }
+        }
+
+        chunked_texts.add();
+        chunks_sent.add(assembly->remaining);
+        if (assembly->remaining == 0) {
+            // Nothing but code and whitespace: the text is its own translation
+            assembly->result.text = request.text;
+            event_loop().post([pending, assembly]() { pending->complete(assembly->index, assembly->result); });
+        }
+    }
+
+    inner_->translate_async(std::move(upstream), [pending, slots](size_t i, TranslationResult& result) {
+        Slot& slot = (*slots)[i];
+        if (!slot.assembly) {
+            pending->complete(slot.index, result);
+            return;
+        }
+
+        Assembly& assembly = *slot.assembly;
+        if (result.ok) {
+            assembly.chunks[slot.chunk].text = std::move(result.text);
+        } else if (assembly.result.ok) {
+            assembly.result.ok = false;
+            assembly.result.status = result.status;
+        }
+        if (assembly.result.detected_lang.empty()) {
+            assembly.result.detected_lang = result.detected_lang;
+        }
+
+        if (--assembly.remaining > 0) {
+            return;
+        }
+        if (assembly.result.ok) {
+            for (const auto& chunk : assembly.chunks) {
+                assembly.result.text += chunk.text;
+            }
+        }
+        pending->complete(assembly.index, assembly.result);
+    });
+}
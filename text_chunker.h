@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "translation_backend.h"
+
+// A piece of a message. Verbatim pieces (fenced code blocks and the
+// whitespace between chunks) are copied to the output untouched.
+struct TextChunk {
+    std::string text;
+    bool translate = true;
+};
+
+// Split text into translatable chunks of at most max_chars bytes, cutting
+// at paragraph breaks where possible, then line breaks, sentence ends and
+// spaces, and never inside an inline code span or a UTF-8 sequence. Fenced
+// ``` code blocks become verbatim chunks. Joining every chunk's text gives
+// back the original.
+std::vector<TextChunk> split_into_chunks(const std::string& text, size_t max_chars);
+
+// Split text into one translatable chunk per sentence or line, with the
+// same handling of code and whitespace as split_into_chunks
+std::vector<TextChunk> split_sentences(const std::string& text);
+
+// Backend wrapper that splits long texts, and texts containing code
+// blocks, into chunks that are translated concurrently and reassembled in
+// order. A text only succeeds if every chunk did, so a failure never
+// shows up as a partly translated message.
+class ChunkingBackend : public TranslationBackend {
+public:
+    ChunkingBackend(std::unique_ptr<TranslationBackend> inner, size_t max_chars);
+
+    const char* name() const override { return inner_->name(); }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+    void warm_up(WarmUpFunction on_done) override { inner_->warm_up(std::move(on_done)); }
+
+private:
+    std::unique_ptr<TranslationBackend> inner_;
+    const size_t max_chars_;
+};
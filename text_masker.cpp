@@ -0,0 +1,195 @@
+#include "text_masker.h"
+
+// Longest mention masked, e.g. "<t:1700000000:R>" or "</command group sub:123>"
+static const size_t MAX_MENTION_BYTES = 100;
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_ascii_alnum(char c) {
+    char lower = c | 0x20;
+    return is_digit(c) || (lower >= 'a' && lower <= 'z');
+}
+
+static bool starts_with(const std::string& text, size_t i, const char* prefix) {
+    return text.compare(i, std::char_traits<char>::length(prefix), prefix) == 0;
+}
+
+// `inline code`, ``code with ` inside`` and ```fenced blocks```
+static size_t code_span(const std::string& text, size_t i) {
+    size_t run = 0;
+    while (i + run < text.size() && text[i + run] == '`') {
+        ++run;
+    }
+    size_t close = text.find(std::string(run, '`'), i + run);
+    return close == std::string::npos ? 0 : close + run - i;
+}
+
+// <@user>, <@!user>, <@&role>, <#channel>, </command:id>, <t:unix:style>, <:emote:id>
+static size_t mention_span(const std::string& text, size_t i) {
+    static const char* const PREFIXES[] = {"<@", "<#", "</", "<t:", "<:", "<a:"};
+
+    bool known = false;
+    for (const char* prefix : PREFIXES) {
+        known = known || starts_with(text, i, prefix);
+    }
+    if (!known) {
+        return 0;
+    }
+
+    bool digits = false;
+    for (size_t j = i + 1; j < text.size() && j - i < MAX_MENTION_BYTES; ++j) {
+        if (text[j] == '>') {
+            return digits ? j + 1 - i : 0;
+        }
+        if (text[j] == '\n' || text[j] == '<') {
+            return 0;
+        }
+        digits = digits || is_digit(text[j]);
+    }
+    return 0;
+}
+
+static size_t url_span(const std::string& text, size_t i) {
+    if (!starts_with(text, i, "http://") && !starts_with(text, i, "https://")) {
+        return 0;
+    }
+
+    size_t end = i;
+    size_t open_parens = 0;
+    while (end < text.size() && text[end] != ' ' && text[end] != '\n' && text[end] != '\t' && text[end] != '<' &&
+           text[end] != '>') {
+        open_parens += text[end] == '(';
+        ++end;
+    }
+
+    // Punctuation right after a link belongs to the sentence
+    while (end > i) {
+        char last = text[end - 1];
+        if (last == '.' || last == ',' || last == ';' || last == ':' || last == '!' || last == '?' ||
+            last == '\'' || last == '"' || (last == ')' && open_parens == 0)) {
+            --end;
+        } else {
+            break;
+        }
+    }
+    return end - i;
+}
+
+// 42, 3.14, 1,000, 10:30; not the digits of words like "3rd" or "mp3"
+static size_t number_span(const std::string& text, size_t i) {
+    if (i > 0 && is_ascii_alnum(text[i - 1])) {
+        return 0;
+    }
+
+    size_t end = i;
+    while (end < text.size() && is_digit(text[end])) {
+        ++end;
+        if (end + 1 < text.size() && (text[end] == '.' || text[end] == ',' || text[end] == ':') &&
+            is_digit(text[end + 1])) {
+            ++end;
+        }
+    }
+    if (end < text.size() && is_ascii_alnum(text[end])) {
+        return 0;
+    }
+    return end - i;
+}
+
+// Text that would be mistaken for a placeholder
+static size_t placeholder_span(const std::string& text, size_t i) {
+    size_t end = i + 1;
+    while (end < text.size() && is_digit(text[end])) {
+        ++end;
+    }
+    return end > i + 1 && end < text.size() && text[end] == '}' ? end + 1 - i : 0;
+}
+
+static size_t span_at(const std::string& text, size_t i) {
+    switch (text[i]) {
+        case '`': return code_span(text, i);
+        case '<': return mention_span(text, i);
+        case 'h': return i > 0 && is_ascii_alnum(text[i - 1]) ? 0 : url_span(text, i);
+        case '{': return placeholder_span(text, i);
+        default: return is_digit(text[i]) ? number_span(text, i) : 0;
+    }
+}
+
+MaskedText mask_spans(const std::string& text) {
+    MaskedText masked;
+    size_t copied = 0;
+
+    for (size_t i = 0; i < text.size();) {
+        size_t length = span_at(text, i);
+        if (length == 0) {
+            ++i;
+            continue;
+        }
+
+        if (masked.spans.empty()) {
+            masked.text.reserve(text.size());
+        }
+        masked.text.append(text, copied, i - copied);
+        masked.text += '{';
+        masked.text += std::to_string(masked.spans.size());
+        masked.text += '}';
+        masked.spans.push_back(text.substr(i, length));
+        i += length;
+        copied = i;
+    }
+
+    if (masked.spans.empty()) {
+        masked.text = text;
+    } else {
+        masked.text.append(text, copied, std::string::npos);
+    }
+    return masked;
+}
+
+bool unmask_spans(const std::string& translated, const MaskedText& masked, std::string& out) {
+    out.clear();
+    if (masked.spans.empty()) {
+        out = translated;
+        return true;
+    }
+
+    std::vector<bool> restored(masked.spans.size());
+    size_t copied = 0;
+    for (size_t i = translated.find('{'); i != std::string::npos; i = translated.find('{', i + 1)) {
+        // Translators sometimes pad the number with spaces
+        size_t j = i + 1;
+        while (j < translated.size() && translated[j] == ' ') {
+            ++j;
+        }
+        size_t index = 0;
+        size_t digits = 0;
+        while (j < translated.size() && is_digit(translated[j]) && digits < 6) {
+            index = index * 10 + (translated[j++] - '0');
+            ++digits;
+        }
+        while (j < translated.size() && translated[j] == ' ') {
+            ++j;
+        }
+        if (digits == 0 || j >= translated.size() || translated[j] != '}' || index >= restored.size()) {
+            continue;
+        }
+        if (restored[index]) {
+            return false;
+        }
+
+        restored[index] = true;
+        out.append(translated, copied, i - copied);
+        out += masked.spans[index];
+        copied = j + 1;
+        i = j;
+    }
+    out.append(translated, copied, std::string::npos);
+
+    for (bool done : restored) {
+        if (!done) {
+            return false;
+        }
+    }
+    return true;
+}
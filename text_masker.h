@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Text with the spans that must not be translated (code, links, mentions,
+// numbers) replaced by numbered placeholders: "{0}", "{1}", ...
+struct MaskedText {
+    std::string text;
+    std::vector<std::string> spans;  // Original text of each placeholder
+};
+
+// Mask fenced and inline code, http(s) links, Discord mentions, channel and
+// role references, slash command mentions and timestamps, and numbers. Text
+// that already looks like a placeholder is masked too, so restoring never
+// touches anything the author wrote.
+MaskedText mask_spans(const std::string& text);
+
+// Put the masked spans back into a translation of masked.text. Returns false
+// if the translator dropped or duplicated a placeholder.
+bool unmask_spans(const std::string& translated, const MaskedText& masked, std::string& out);
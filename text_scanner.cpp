@@ -0,0 +1,263 @@
+#include "text_scanner.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline bool is_ascii_space(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool is_ascii_letter(unsigned char c) {
+    unsigned char lower = c | 0x20;
+    return lower >= 'a' && lower <= 'z';
+}
+
+static inline bool is_ascii_digit(unsigned char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Emoji, pictographs and the invisible characters used to compose them
+static bool is_emoji(uint32_t cp) {
+    return (cp >= 0x1F000 && cp <= 0x1FAFF) ||  // Mahjong through Symbols and Pictographs Extended-A
+           (cp >= 0x2300 && cp <= 0x23FF) ||    // Miscellaneous Technical (watch, hourglass, media keys)
+           (cp >= 0x2500 && cp <= 0x2BEF) ||    // Box drawing through Miscellaneous Symbols and Arrows
+           (cp >= 0xFE00 && cp <= 0xFE0F) ||    // Variation selectors
+           (cp >= 0xE0020 && cp <= 0xE007F) ||  // Tag characters (subdivision flags)
+           cp == 0x200D ||                      // Zero width joiner
+           cp == 0x20E3 ||                      // Combining enclosing keycap
+           cp == 0x24C2 ||
+           cp == 0x3030;
+}
+
+Script script_of(uint32_t cp) {
+    if (cp < 0x0370) {
+        if (cp < 0x80 && is_ascii_letter(static_cast<unsigned char>(cp))) {
+            return Script::Latin;
+        }
+        if ((cp >= 0x00C0 && cp <= 0x024F) && cp != 0x00D7 && cp != 0x00F7) {
+            return Script::Latin;
+        }
+        return Script::Count;
+    }
+    if (cp <= 0x03FF) return Script::Greek;
+    if (cp <= 0x052F) return Script::Cyrillic;
+    if (cp >= 0x0590 && cp <= 0x05FF) return Script::Hebrew;
+    if ((cp >= 0x0600 && cp <= 0x06FF) || (cp >= 0x0750 && cp <= 0x077F)) return Script::Arabic;
+    if (cp >= 0x0900 && cp <= 0x097F) return Script::Devanagari;
+    if (cp >= 0x0980 && cp <= 0x09FF) return Script::Bengali;
+    if (cp >= 0x0B80 && cp <= 0x0BFF) return Script::Tamil;
+    if (cp >= 0x0E00 && cp <= 0x0E7F) return Script::Thai;
+    if (cp >= 0x1100 && cp <= 0x11FF) return Script::Hangul;
+    if (cp >= 0x1E00 && cp <= 0x1EFF) return Script::Latin;
+    if (cp >= 0x1F00 && cp <= 0x1FFF) return Script::Greek;
+    if (cp >= 0x2000 && cp <= 0x2BFF) return Script::Count;  // Punctuation and symbols
+    if (cp >= 0x3000 && cp <= 0x303F) return Script::Count;  // CJK punctuation
+    if ((cp >= 0x3040 && cp <= 0x30FF) || (cp >= 0x31F0 && cp <= 0x31FF)) return Script::Kana;
+    if (cp >= 0x3130 && cp <= 0x318F) return Script::Hangul;
+    if ((cp >= 0x3400 && cp <= 0x4DBF) || (cp >= 0x4E00 && cp <= 0x9FFF)) return Script::Han;
+    if (cp >= 0xAC00 && cp <= 0xD7AF) return Script::Hangul;
+    if (cp >= 0xF900 && cp <= 0xFAFF) return Script::Han;
+    if ((cp >= 0xFB50 && cp <= 0xFDFF) || (cp >= 0xFE70 && cp <= 0xFEFF)) return Script::Arabic;
+    if (cp >= 0xFF00 && cp <= 0xFF65) return Script::Count;  // Fullwidth forms
+    if (cp >= 0xFF66 && cp <= 0xFF9F) return Script::Kana;
+    if (cp >= 0x20000 && cp <= 0x2FA1F) return Script::Han;
+    return Script::Other;
+}
+
+size_t decode_utf8(const std::string& text, size_t i, uint32_t& cp) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data()) + i;
+    size_t remaining = text.size() - i;
+    unsigned char lead = p[0];
+
+    size_t length;
+    if (lead < 0x80) {
+        cp = lead;
+        return 1;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        cp = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        cp = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        cp = lead & 0x07;
+    } else {
+        return 0;
+    }
+
+    if (remaining < length) {
+        return 0;
+    }
+    for (size_t k = 1; k < length; ++k) {
+        if ((p[k] & 0xC0) != 0x80) {
+            return 0;
+        }
+        cp = (cp << 6) | (p[k] & 0x3F);
+    }
+    return length;
+}
+
+// Length of a Discord custom emoji (<:name:id> or <a:name:id>) at text[i], or 0
+static size_t custom_emoji_length(const std::string& text, size_t i) {
+    size_t j = i + 1;
+    if (j < text.size() && text[j] == 'a') {
+        ++j;
+    }
+    if (j >= text.size() || text[j] != ':') {
+        return 0;
+    }
+
+    size_t name_start = ++j;
+    while (j < text.size() && (is_ascii_letter(text[j]) || is_ascii_digit(text[j]) || text[j] == '_')) {
+        ++j;
+    }
+    if (j == name_start || j >= text.size() || text[j] != ':') {
+        return 0;
+    }
+
+    size_t id_start = ++j;
+    while (j < text.size() && is_ascii_digit(text[j])) {
+        ++j;
+    }
+    if (j == id_start || j >= text.size() || text[j] != '>') {
+        return 0;
+    }
+
+    return j + 1 - i;
+}
+
+static bool starts_with_http(const std::string& text, size_t& prefix_length) {
+    auto lower_at = [&text](size_t i) { return static_cast<char>(text[i] | 0x20); };
+
+    if (text.size() < 7 || lower_at(0) != 'h' || lower_at(1) != 't' || lower_at(2) != 't' || lower_at(3) != 'p') {
+        return false;
+    }
+    size_t i = 4;
+    if (lower_at(i) == 's') {
+        ++i;
+    }
+    if (text.compare(i, 3, "://") != 0) {
+        return false;
+    }
+    prefix_length = i + 3;
+    return true;
+}
+
+#if defined(__SSE2__)
+static inline uint32_t popcount16(uint32_t mask) {
+    return static_cast<uint32_t>(__builtin_popcount(mask));
+}
+
+// Handle a 16-byte block if it is plain ASCII with no '<'. Returns false otherwise.
+static bool scan_ascii_block(const char* p, TextScan& scan, uint32_t& spaces) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (_mm_movemask_epi8(v) != 0) {
+        return false;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('<'))) != 0) {
+        return false;
+    }
+
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                    _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                                               _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))));
+
+    uint32_t block_spaces = popcount16(_mm_movemask_epi8(space));
+    scan.script_chars[static_cast<size_t>(Script::Latin)] += popcount16(_mm_movemask_epi8(letters));
+    scan.non_space_chars += 16 - block_spaces;
+    spaces += block_spaces;
+    scan.cleaned.append(p, 16);
+    return true;
+}
+#endif
+
+Script TextScan::dominant_script() const {
+    Script best = Script::Other;
+    uint32_t best_count = 0;
+    for (size_t i = 0; i < script_chars.size(); ++i) {
+        if (script_chars[i] > best_count) {
+            best_count = script_chars[i];
+            best = static_cast<Script>(i);
+        }
+    }
+    return best;
+}
+
+uint32_t TextScan::letters() const {
+    uint32_t total = 0;
+    for (uint32_t count : script_chars) {
+        total += count;
+    }
+    return total;
+}
+
+TextScan scan_text(const std::string& text) {
+    TextScan scan;
+    scan.cleaned.reserve(text.size());
+
+    uint32_t spaces = 0;
+    size_t i = 0;
+    const size_t n = text.size();
+
+    while (i < n) {
+#if defined(__SSE2__)
+        if (i + 16 <= n && scan_ascii_block(text.data() + i, scan, spaces)) {
+            i += 16;
+            continue;
+        }
+#endif
+        unsigned char c = static_cast<unsigned char>(text[i]);
+
+        if (c < 0x80) {
+            if (c == '<') {
+                size_t emoji_length = custom_emoji_length(text, i);
+                if (emoji_length > 0) {
+                    i += emoji_length;
+                    continue;
+                }
+            }
+
+            if (is_ascii_space(c)) {
+                ++spaces;
+            } else {
+                ++scan.non_space_chars;
+                if (is_ascii_letter(c)) {
+                    ++scan.script_chars[static_cast<size_t>(Script::Latin)];
+                }
+            }
+            scan.cleaned += static_cast<char>(c);
+            ++i;
+            continue;
+        }
+
+        uint32_t cp = 0;
+        size_t length = decode_utf8(text, i, cp);
+        if (length == 0) {
+            // Keep malformed bytes as-is rather than guessing
+            scan.cleaned += static_cast<char>(c);
+            ++scan.non_space_chars;
+            ++i;
+            continue;
+        }
+
+        if (!is_emoji(cp)) {
+            Script script = script_of(cp);
+            if (script != Script::Count) {
+                ++scan.script_chars[static_cast<size_t>(script)];
+            }
+            ++scan.non_space_chars;
+            scan.cleaned.append(text, i, length);
+        }
+        i += length;
+    }
+
+    size_t prefix_length = 0;
+    scan.url_only = spaces == 0 && starts_with_http(text, prefix_length) && text.size() > prefix_length;
+
+    return scan;
+}
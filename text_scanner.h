@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Writing systems the bot distinguishes when detecting languages
+enum class Script : uint8_t {
+    Latin,
+    Cyrillic,
+    Greek,
+    Arabic,
+    Hebrew,
+    Devanagari,
+    Bengali,
+    Tamil,
+    Thai,
+    Hangul,
+    Kana,
+    Han,
+    Other,
+    Count
+};
+
+struct TextScan {
+    std::string cleaned;          // Input with Unicode and Discord custom emoji removed
+    bool url_only = false;        // The whole message is a single http(s) link
+    uint32_t non_space_chars = 0; // Code points in cleaned text, excluding whitespace
+    std::array<uint32_t, static_cast<size_t>(Script::Count)> script_chars{};
+
+    uint32_t count(Script script) const { return script_chars[static_cast<size_t>(script)]; }
+
+    // Letters of any script
+    uint32_t letters() const;
+
+    // Script with the most letters, or Other if there are no letters at all
+    Script dominant_script() const;
+};
+
+// Decode one UTF-8 sequence at text[i]. Returns its length, or 0 if malformed.
+size_t decode_utf8(const std::string& text, size_t i, uint32_t& cp);
+
+// Script of a code point; Script::Count for digits, punctuation and symbols
+Script script_of(uint32_t cp);
+
+// Single pass over UTF-8 text: strips emoji, detects link-only messages and
+// counts letters per script. Pure ASCII runs take a vectorized fast path.
+TextScan scan_text(const std::string& text);
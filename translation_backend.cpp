@@ -0,0 +1,295 @@
+#include "translation_backend.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <future>
+#include <iostream>
+
+#include "config.h"
+#include "event_loop.h"
+#include "http_client.h"
+#include "json_cursor.h"
+#include "metrics.h"
+#include "single_flight.h"
+#include "text_chunker.h"
+#include "translator.h"
+#include "upstream_governor.h"
+
+using json = nlohmann::json;
+
+static Histogram parse_seconds("translator_parse_seconds", "Time to parse translation responses");
+
+void TranslationBackend::translate_many(const std::vector<TranslationRequest>& requests,
+                                        const CompletionFunction& on_complete) {
+    if (event_loop().in_loop_thread()) {
+        std::cerr << "Blocking translation requested on the event loop thread" << std::endl;
+        return;
+    }
+
+    auto finished = std::make_shared<std::promise<void>>();
+    std::future<void> done = finished->get_future();
+    translate_async(requests, on_complete, [finished]() { finished->set_value(); });
+    done.wait();
+}
+
+TranslationResult TranslationBackend::translate(const TranslationRequest& request) {
+    TranslationResult result;
+    translate_many({request}, [&result](size_t, TranslationResult& done) { result = std::move(done); });
+    return result;
+}
+
+void TranslationBackend::warm_up(WarmUpFunction on_done) {
+    if (on_done) {
+        event_loop().post([on_done]() { on_done(true); });
+    }
+}
+
+// Any answer at all means the connection is up
+static void warm_up_url(const std::string& url, TranslationBackend::WarmUpFunction on_done) {
+    http_client().send_async(HttpRequest{url, "", ""}, [on_done](HttpResponse& response) {
+        if (on_done) {
+            on_done(response.error == CURLE_OK);
+        }
+    });
+}
+
+std::shared_ptr<PendingRequests> PendingRequests::start(size_t count, TranslationBackend::CompletionFunction on_complete,
+                                                        TranslationBackend::DoneFunction on_done) {
+    auto pending = std::make_shared<PendingRequests>();
+    pending->remaining_ = count;
+    pending->on_complete_ = std::move(on_complete);
+    pending->on_done_ = std::move(on_done);
+
+    if (count == 0 && pending->on_done_) {
+        event_loop().post(std::move(pending->on_done_));
+    }
+    return pending;
+}
+
+void PendingRequests::complete(size_t index, TranslationResult& result) {
+    if (on_complete_) {
+        on_complete_(index, result);
+    }
+    if (--remaining_ == 0 && on_done_) {
+        on_done_();
+    }
+}
+
+// Google
+
+// Only the short parameters go in the URL; the text is sent as a form body
+// so long or non-Latin messages never run into URL length limits
+static HttpRequest google_request(const TranslationRequest& request) {
+    HttpRequest post;
+    post.url = "https://translate.googleapis.com/translate_a/single?client=gtx&sl=" + request.source_lang +
+               "&tl=" + request.target_lang + "&dt=t";
+    post.body = "q=";
+    url_encode_into(post.body, request.text);
+    post.content_type = "application/x-www-form-urlencoded;charset=utf-8";
+    return post;
+}
+
+// Pull the translated text and the detected source language out of a
+// translate_a/single response, straight from the received bytes
+static bool parse_google(const std::string& body, std::string& translated, std::string& detected) {
+    auto start = std::chrono::steady_clock::now();
+    translated.reserve(body.size() / 2);
+    if (!extract_google_translation(body, translated, detected)) {
+        std::cerr << "Translation parse error: unexpected response of " << body.size() << " bytes" << std::endl;
+        return false;
+    }
+    parse_seconds.observe(std::chrono::steady_clock::now() - start);
+    return true;
+}
+
+void GoogleBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                    DoneFunction on_done) {
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        http_client().send_async(google_request(requests[i]), [pending, i](HttpResponse& response) {
+            TranslationResult result;
+            result.status = response.status;
+            result.ok = response.ok() && parse_google(response.body, result.text, result.detected_lang) &&
+                        !result.text.empty();
+            pending->complete(i, result);
+        });
+    }
+}
+
+void GoogleBackend::warm_up(WarmUpFunction on_done) {
+    warm_up_url("https://translate.googleapis.com/", std::move(on_done));
+}
+
+// LibreTranslate
+
+// LibreTranslate uses ISO 639-1 codes where Google keeps older or regional ones
+static std::string to_libre(const std::string& code) {
+    if (code == "iw") {
+        return "he";
+    }
+    if (code == "zh-CN") {
+        return "zh";
+    }
+    if (code == "tl") {
+        return "fil";
+    }
+    return code;
+}
+
+static std::string from_libre(const std::string& code) {
+    if (code == "he") {
+        return "iw";
+    }
+    if (code == "zh" || code == "zh-Hans") {
+        return "zh-CN";
+    }
+    if (code == "fil") {
+        return "tl";
+    }
+    return code;
+}
+
+LibreTranslateBackend::LibreTranslateBackend(std::string base_url, std::string api_key)
+    : base_url_(std::move(base_url)), api_key_(std::move(api_key)) {
+    while (!base_url_.empty() && base_url_.back() == '/') {
+        base_url_.pop_back();
+    }
+    url_ = base_url_ + "/translate";
+}
+
+void LibreTranslateBackend::warm_up(WarmUpFunction on_done) {
+    warm_up_url(base_url_ + "/languages", std::move(on_done));
+}
+
+void LibreTranslateBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                            DoneFunction on_done) {
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const TranslationRequest& request = requests[i];
+        json body = {
+            {"q", request.text},
+            {"source", to_libre(request.source_lang)},
+            {"target", to_libre(request.target_lang)},
+            {"format", "text"},
+        };
+        if (!api_key_.empty()) {
+            body["api_key"] = api_key_;
+        }
+
+        http_client().send_async(HttpRequest{url_, body.dump()}, [pending, i](HttpResponse& response) {
+            TranslationResult result;
+            result.status = response.status;
+
+            if (response.ok()) {
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    auto j = json::parse(response.body);
+                    result.text = j.value("translatedText", "");
+                    auto detected = j.find("detectedLanguage");
+                    if (detected != j.end() && detected->is_object()) {
+                        result.detected_lang = from_libre(detected->value("language", ""));
+                    }
+                    result.ok = !result.text.empty();
+                    parse_seconds.observe(std::chrono::steady_clock::now() - start);
+                } catch (const std::exception& e) {
+                    std::cerr << "Translation parse error: " << e.what() << std::endl;
+                }
+            }
+
+            pending->complete(i, result);
+        });
+    }
+}
+
+// Mock
+
+MockBackend::MockBackend(MockBackendOptions options) : options_(std::move(options)), rng_(options_.seed) {}
+
+void MockBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                  DoneFunction on_done) {
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+
+    std::lock_guard<std::mutex> lock(rng_mutex_);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::uniform_int_distribution<long> jitter(0, options_.jitter.count());
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        TranslationRequest& request = requests[i];
+
+        double roll = chance(rng_);
+        TranslationResult result;
+        result.status = 200;
+        if (roll < options_.rate_limit_rate) {
+            result.status = 429;
+        } else if (roll < options_.rate_limit_rate + options_.error_rate) {
+            result.status = 500;
+        } else {
+            result.ok = true;
+            result.text = "[" + request.target_lang + "] " + request.text;
+            if (request.source_lang == "auto") {
+                result.detected_lang = options_.detected_lang;
+            }
+        }
+
+        auto delay = options_.latency + std::chrono::milliseconds(jitter(rng_));
+        event_loop().post_after(delay, [pending, i, result = std::move(result)]() mutable {
+            pending->complete(i, result);
+        });
+    }
+}
+
+std::unique_ptr<TranslationBackend> make_translation_backend(const std::string& name) {
+    if (name == "google") {
+        return std::make_unique<GoogleBackend>();
+    }
+
+    if (name == "libretranslate") {
+        return std::make_unique<LibreTranslateBackend>(
+            config_string("LIBRETRANSLATE_URL", "http://localhost:5000"),
+            config_string("LIBRETRANSLATE_API_KEY"));
+    }
+
+    if (name == "mock") {
+        MockBackendOptions options;
+        options.latency = std::chrono::milliseconds(std::max<long>(config_int("MOCK_LATENCY_MS", 50), 0));
+        options.jitter = std::chrono::milliseconds(std::max<long>(config_int("MOCK_JITTER_MS", 0), 0));
+        options.error_rate = config_double("MOCK_ERROR_RATE", 0.0);
+        options.rate_limit_rate = config_double("MOCK_RATE_LIMIT_RATE", 0.0);
+        options.detected_lang = config_string("MOCK_DETECTED_LANG", "en");
+        return std::make_unique<MockBackend>(options);
+    }
+
+    return nullptr;
+}
+
+static SingleFlightBackend& shared_backend() {
+    static std::unique_ptr<SingleFlightBackend> backend = []() {
+        std::string name = config_string("TRANSLATION_BACKEND", "google");
+        std::unique_ptr<TranslationBackend> selected = make_translation_backend(name);
+        if (!selected) {
+            std::cerr << "Unknown TRANSLATION_BACKEND '" << name << "', using google" << std::endl;
+            selected = std::make_unique<GoogleBackend>();
+        }
+        // Construct the HTTP client, governor and event loop first so they
+        // outlive the backend at exit; the client and the governor also
+        // outlive the loop, which may still run the governor's retries
+        http_client();
+        upstream_governor();
+        event_loop();
+        auto governed = std::make_unique<GovernedBackend>(std::move(selected), upstream_governor());
+        auto chunked = std::make_unique<ChunkingBackend>(std::move(governed), config_int("CHUNK_MAX_CHARS", 1000));
+        return std::make_unique<SingleFlightBackend>(std::move(chunked));
+    }();
+    return *backend;
+}
+
+TranslationBackend& translation_backend() {
+    return shared_backend();
+}
+
+uint64_t single_flight_saved() {
+    return shared_backend().saved();
+}
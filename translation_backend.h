@@ -0,0 +1,132 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+struct TranslationRequest {
+    std::string text;
+    std::string source_lang;  // "auto" to have the backend detect it
+    std::string target_lang;
+};
+
+struct TranslationResult {
+    bool ok = false;
+    long status = 0;            // HTTP status, or 0 if the request never got a response
+    std::string text;
+    std::string detected_lang;  // Set when the source was "auto" and the backend reported it
+};
+
+// A translation service. Implementations must be safe to call from several
+// threads at once. Language codes are Google-style ("zh-CN", "iw"); backends
+// that use other codes convert them.
+class TranslationBackend {
+public:
+    using CompletionFunction = std::function<void(size_t index, TranslationResult& result)>;
+    using DoneFunction = std::function<void()>;
+    using WarmUpFunction = std::function<void(bool connected)>;
+
+    virtual ~TranslationBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // Start the requests and return at once. on_complete runs on the event
+    // loop thread as each request finishes, then on_done once after the last.
+    virtual void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                 DoneFunction on_done = nullptr) = 0;
+
+    // Resolve and connect to the service ahead of the first translation, so
+    // it doesn't pay for DNS, TCP and TLS. The connection stays in the event
+    // loop's pool. on_done runs on the loop thread; backends with nothing to
+    // connect to report success right away.
+    virtual void warm_up(WarmUpFunction on_done);
+
+    // Blocking forms of translate_async, with on_complete called on the event
+    // loop thread while the caller waits. Never call these on the loop thread.
+    void translate_many(const std::vector<TranslationRequest>& requests, const CompletionFunction& on_complete);
+    TranslationResult translate(const TranslationRequest& request);
+};
+
+// Tracks the outstanding requests of one translate_async call. Only used on
+// the event loop thread, so the count needs no lock.
+class PendingRequests {
+public:
+    // Calls on_done right away (on the loop) when there is nothing to wait for
+    static std::shared_ptr<PendingRequests> start(size_t count, TranslationBackend::CompletionFunction on_complete,
+                                                  TranslationBackend::DoneFunction on_done);
+
+    void complete(size_t index, TranslationResult& result);
+
+private:
+    size_t remaining_ = 0;
+    TranslationBackend::CompletionFunction on_complete_;
+    TranslationBackend::DoneFunction on_done_;
+};
+
+// Unofficial translate.googleapis.com endpoint (client=gtx)
+class GoogleBackend : public TranslationBackend {
+public:
+    const char* name() const override { return "google"; }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+    void warm_up(WarmUpFunction on_done) override;
+};
+
+// LibreTranslate's POST /translate API, or any server compatible with it
+class LibreTranslateBackend : public TranslationBackend {
+public:
+    LibreTranslateBackend(std::string base_url, std::string api_key);
+
+    const char* name() const override { return "libretranslate"; }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+    void warm_up(WarmUpFunction on_done) override;
+
+private:
+    std::string base_url_;
+    std::string url_;
+    std::string api_key_;
+};
+
+struct MockBackendOptions {
+    std::chrono::milliseconds latency{50};
+    std::chrono::milliseconds jitter{0};  // Added uniformly at random to each request
+    double error_rate = 0.0;              // Fraction of requests answered with 500
+    double rate_limit_rate = 0.0;         // Fraction of requests answered with 429
+    std::string detected_lang = "en";     // Reported for "auto" requests
+    uint32_t seed = 1;
+};
+
+// In-process stand-in for load tests and benchmarks. Each request completes
+// on the event loop after its simulated latency; a translation is the text
+// prefixed with its target code, e.g. "[de] hello".
+class MockBackend : public TranslationBackend {
+public:
+    explicit MockBackend(MockBackendOptions options);
+
+    const char* name() const override { return "mock"; }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+
+private:
+    MockBackendOptions options_;
+    std::mutex rng_mutex_;
+    std::mt19937 rng_;
+};
+
+// Build a backend by name ("google", "libretranslate" or "mock") from the
+// config. Returns nullptr for an unknown name.
+std::unique_ptr<TranslationBackend> make_translation_backend(const std::string& name);
+
+// Process-wide backend selected by TRANSLATION_BACKEND, paced and retried
+// by the upstream governor, with long texts split into chunks and
+// identical in-flight requests collapsed
+TranslationBackend& translation_backend();
+
+// Requests answered by an identical request already in flight
+uint64_t single_flight_saved();
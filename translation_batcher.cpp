@@ -0,0 +1,117 @@
+#include "translation_batcher.h"
+
+#include <algorithm>
+
+TranslationBatcher::TranslationBatcher(std::chrono::milliseconds window, size_t max_items, size_t max_chars,
+                                       FlushFunction flush)
+    : window_(window),
+      max_items_(std::max<size_t>(max_items, 1)),
+      max_chars_(max_chars),
+      flush_(std::move(flush)),
+      flusher_(&TranslationBatcher::flush_loop, this) {}
+
+TranslationBatcher::~TranslationBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    flusher_.join();
+}
+
+void TranslationBatcher::close_batch(Pending& pending) {
+    ++batches_;
+    items_ += pending.batch.items.size();
+    ready_.push_back(std::move(pending.batch));
+}
+
+void TranslationBatcher::submit(const std::string& source_lang, const std::string& target_lang, std::string text,
+                                std::function<void(const std::string&)> done) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto key = std::make_pair(source_lang, target_lang);
+        auto it = pending_.find(key);
+
+        // Start over if this text would push the open batch past its size limit
+        if (it != pending_.end() && it->second.chars + text.size() > max_chars_) {
+            close_batch(it->second);
+            pending_.erase(it);
+            it = pending_.end();
+        }
+
+        if (it == pending_.end()) {
+            Pending pending;
+            pending.batch.source_lang = source_lang;
+            pending.batch.target_lang = target_lang;
+            pending.deadline = std::chrono::steady_clock::now() + window_;
+            it = pending_.emplace(key, std::move(pending)).first;
+        }
+
+        it->second.chars += text.size();
+        it->second.batch.items.push_back({std::move(text), std::move(done)});
+
+        if (it->second.batch.items.size() >= max_items_ || it->second.chars >= max_chars_) {
+            close_batch(it->second);
+            pending_.erase(it);
+        }
+    }
+    cv_.notify_one();
+}
+
+void TranslationBatcher::record_split_failure() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++split_failures_;
+}
+
+BatchStats TranslationBatcher::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    BatchStats s;
+    s.batches = batches_;
+    s.items = items_;
+    s.split_failures = split_failures_;
+    if (batches_ > 0) {
+        s.fill_ratio = static_cast<double>(items_) / (batches_ * max_items_);
+    }
+    return s;
+}
+
+void TranslationBatcher::flush_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+
+        for (auto it = pending_.begin(); it != pending_.end();) {
+            if (stopping_ || it->second.deadline <= now) {
+                close_batch(it->second);
+                it = pending_.erase(it);
+            } else {
+                next_deadline = std::min(next_deadline, it->second.deadline);
+                ++it;
+            }
+        }
+
+        if (!ready_.empty()) {
+            std::vector<Batch> batches;
+            batches.swap(ready_);
+
+            lock.unlock();
+            flush_(batches);
+            lock.lock();
+            continue;
+        }
+
+        if (stopping_) {
+            return;
+        }
+
+        if (pending_.empty()) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_until(lock, next_deadline);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct BatchItem {
+    std::string text;
+    std::function<void(const std::string& translated)> done;  // "" on failure
+};
+
+// Texts sharing a source and target language, sent upstream as one request
+struct Batch {
+    std::string source_lang;
+    std::string target_lang;
+    std::vector<BatchItem> items;
+};
+
+struct BatchStats {
+    uint64_t batches = 0;
+    uint64_t items = 0;
+    uint64_t split_failures = 0;
+    double fill_ratio = 0.0;  // Average items per batch relative to the size limit
+};
+
+// Coalesces translation requests per (source, target) pair. A batch is
+// flushed when its window expires or it reaches the item or character
+// limit. Flushing happens on a background thread through the supplied
+// function, which must call every item's done callback.
+class TranslationBatcher {
+public:
+    using FlushFunction = std::function<void(std::vector<Batch>& batches)>;
+
+    TranslationBatcher(std::chrono::milliseconds window, size_t max_items, size_t max_chars, FlushFunction flush);
+    ~TranslationBatcher();
+
+    TranslationBatcher(const TranslationBatcher&) = delete;
+    TranslationBatcher& operator=(const TranslationBatcher&) = delete;
+
+    void submit(const std::string& source_lang, const std::string& target_lang, std::string text,
+                std::function<void(const std::string& translated)> done);
+
+    // Called by the flush function when a batched response could not be split apart
+    void record_split_failure();
+
+    BatchStats stats();
+
+private:
+    struct Pending {
+        Batch batch;
+        size_t chars = 0;
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    void close_batch(Pending& pending);
+    void flush_loop();
+
+    const std::chrono::milliseconds window_;
+    const size_t max_items_;
+    const size_t max_chars_;
+    FlushFunction flush_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::pair<std::string, std::string>, Pending> pending_;
+    std::vector<Batch> ready_;
+    bool stopping_ = false;
+
+    uint64_t batches_ = 0;
+    uint64_t items_ = 0;
+    uint64_t split_failures_ = 0;
+
+    std::thread flusher_;  // Last, so everything it touches is initialized first
+};
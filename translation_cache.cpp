@@ -0,0 +1,268 @@
+#include "translation_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+static const char SNAPSHOT_MAGIC[4] = {'T', 'C', 'S', '1'};
+
+// Rough per-entry bookkeeping cost (list node, index slot, string headers)
+static const size_t ENTRY_OVERHEAD = 128;
+
+static int64_t unix_now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+TranslationCache::TranslationCache(size_t max_bytes, std::chrono::seconds ttl, size_t shard_count)
+    : ttl_(ttl) {
+    if (shard_count == 0) {
+        shard_count = 1;
+    }
+    shard_budget_ = max_bytes / shard_count;
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+std::string TranslationCache::normalize(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+
+    // Line breaks are kept: the translation keeps them too, so a text that
+    // only differs in its line breaks needs an entry of its own
+    bool pending_space = false;
+    size_t pending_lines = 0;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '\r') {
+            pending_space = !result.empty();
+            continue;
+        }
+        if (c == '\n') {
+            pending_space = false;
+            pending_lines += result.empty() ? 0 : 1;
+            continue;
+        }
+        if (pending_lines > 0) {
+            result.append(pending_lines, '\n');
+            pending_lines = 0;
+        } else if (pending_space) {
+            result += ' ';
+        }
+        pending_space = false;
+        result += c;
+    }
+
+    return result;
+}
+
+std::string TranslationCache::make_key(const std::string& text, const std::string& source, const std::string& target) {
+    std::string key;
+    key.reserve(source.size() + target.size() + text.size() + 2);
+    key += source;
+    key += '\x1f';
+    key += target;
+    key += '\x1f';
+    key += normalize(text);
+    return key;
+}
+
+// 64-bit FNV-1a
+uint64_t TranslationCache::hash_key(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+size_t TranslationCache::entry_size(const Entry& entry) {
+    return entry.key.size() + entry.value.size() + ENTRY_OVERHEAD;
+}
+
+void TranslationCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+    shard.bytes -= entry_size(*it);
+    shard.index.erase(it->hash);
+    shard.lru.erase(it);
+}
+
+bool TranslationCache::get(const std::string& text, const std::string& source, const std::string& target, std::string& value) {
+    std::string key = make_key(text, source, target);
+    uint64_t hash = hash_key(key);
+    Shard& shard = shard_for(hash);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.index.find(hash);
+    if (found == shard.index.end() || found->second->key != key) {
+        ++shard.misses;
+        return false;
+    }
+
+    auto it = found->second;
+    if (it->expires_at <= unix_now()) {
+        erase(shard, it);
+        ++shard.expirations;
+        ++shard.misses;
+        return false;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it);
+    value = it->value;
+    ++shard.hits;
+    return true;
+}
+
+void TranslationCache::put(const std::string& text, const std::string& source, const std::string& target, const std::string& value) {
+    std::string key = make_key(text, source, target);
+    uint64_t hash = hash_key(key);
+    int64_t expires_at = unix_now() + ttl_.count();
+    if (listener_) {
+        listener_(key, value, expires_at);
+    }
+    insert(hash, std::move(key), value, expires_at);
+}
+
+void TranslationCache::put_shared(const std::string& key, std::string value, int64_t expires_at) {
+    if (expires_at > unix_now()) {
+        insert(hash_key(key), key, std::move(value), expires_at);
+    }
+}
+
+void TranslationCache::for_each(const PutListener& visit) const {
+    int64_t now = unix_now();
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto it = shard->lru.rbegin(); it != shard->lru.rend(); ++it) {
+            if (it->expires_at > now) {
+                visit(it->key, it->value, it->expires_at);
+            }
+        }
+    }
+}
+
+void TranslationCache::insert(uint64_t hash, std::string key, std::string value, int64_t expires_at) {
+    Entry entry{hash, std::move(key), std::move(value), expires_at};
+    size_t size = entry_size(entry);
+    if (size > shard_budget_) {
+        return;
+    }
+
+    Shard& shard = shard_for(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Replace any existing entry (same key, or a colliding hash)
+    auto found = shard.index.find(hash);
+    if (found != shard.index.end()) {
+        erase(shard, found->second);
+    }
+
+    while (shard.bytes + size > shard_budget_ && !shard.lru.empty()) {
+        erase(shard, std::prev(shard.lru.end()));
+        ++shard.evictions;
+    }
+
+    shard.lru.push_front(std::move(entry));
+    shard.index[hash] = shard.lru.begin();
+    shard.bytes += size;
+}
+
+CacheStats TranslationCache::stats() const {
+    CacheStats total;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->hits;
+        total.misses += shard->misses;
+        total.evictions += shard->evictions;
+        total.expirations += shard->expirations;
+        total.entries += shard->lru.size();
+        total.bytes += shard->bytes;
+    }
+    return total;
+}
+
+template <typename T>
+static void write_pod(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool read_pod(std::ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static bool read_string(std::ifstream& in, std::string& value) {
+    uint32_t length = 0;
+    if (!read_pod(in, length) || length > (1u << 24)) {
+        return false;
+    }
+    value.resize(length);
+    return static_cast<bool>(in.read(&value[0], length));
+}
+
+bool TranslationCache::save(const std::string& path) const {
+    // The periodic snapshot and the one at shutdown may overlap
+    std::lock_guard<std::mutex> save_lock(save_mutex_);
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    int64_t now = unix_now();
+
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        // Oldest first, so reloading restores the same recency order
+        for (auto it = shard->lru.rbegin(); it != shard->lru.rend(); ++it) {
+            if (it->expires_at <= now) {
+                continue;
+            }
+            write_pod<int64_t>(out, it->expires_at);
+            write_pod<uint32_t>(out, static_cast<uint32_t>(it->key.size()));
+            out.write(it->key.data(), it->key.size());
+            write_pod<uint32_t>(out, static_cast<uint32_t>(it->value.size()));
+            out.write(it->value.data(), it->value.size());
+        }
+    }
+
+    out.close();
+    if (!out) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool TranslationCache::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), SNAPSHOT_MAGIC)) {
+        return false;
+    }
+
+    int64_t now = unix_now();
+    int64_t expires_at = 0;
+    std::string key;
+    std::string value;
+
+    while (read_pod(in, expires_at)) {
+        if (!read_string(in, key) || !read_string(in, value)) {
+            return false;
+        }
+        if (expires_at > now) {
+            uint64_t hash = hash_key(key);
+            insert(hash, std::move(key), std::move(value), expires_at);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Concurrent LRU cache of translation results, keyed by normalized text plus
+// source and target language. Entries are spread over independently locked
+// shards; each shard gets an equal slice of the byte budget.
+class TranslationCache {
+public:
+    TranslationCache(size_t max_bytes, std::chrono::seconds ttl, size_t shard_count = 16);
+
+    bool get(const std::string& text, const std::string& source, const std::string& target, std::string& value);
+    void put(const std::string& text, const std::string& source, const std::string& target, const std::string& value);
+
+    // Called on every put() with the entry's internal key, e.g. to copy it
+    // to other processes. Set it before the cache is shared between threads.
+    using PutListener = std::function<void(const std::string& key, const std::string& value, int64_t expires_at)>;
+    void set_listener(PutListener listener) { listener_ = std::move(listener); }
+
+    // Store an entry handed out by another process's listener
+    void put_shared(const std::string& key, std::string value, int64_t expires_at);
+
+    // Every unexpired entry, oldest first
+    void for_each(const PutListener& visit) const;
+
+    CacheStats stats() const;
+
+    // Snapshot unexpired entries to disk (atomically replaced) and reload them
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // Trim, and collapse runs of spaces and tabs, so trivially different
+    // messages share an entry; line breaks are kept
+    static std::string normalize(const std::string& text);
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::string key;
+        std::string value;
+        int64_t expires_at;  // Unix seconds, so snapshots survive restarts
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // Most recently used at the front
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+    };
+
+    static std::string make_key(const std::string& text, const std::string& source, const std::string& target);
+    static uint64_t hash_key(const std::string& key);
+    static size_t entry_size(const Entry& entry);
+
+    Shard& shard_for(uint64_t hash) { return *shards_[hash % shards_.size()]; }
+    void insert(uint64_t hash, std::string key, std::string value, int64_t expires_at);
+    void erase(Shard& shard, std::list<Entry>::iterator it);
+
+    size_t shard_budget_;
+    std::chrono::seconds ttl_;
+    PutListener listener_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    mutable std::mutex save_mutex_;  // Saves share one temporary file
+};
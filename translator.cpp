@@ -0,0 +1,860 @@
+#include "translator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include "config.h"
+#include "language_detector.h"
+#include "languages.h"
+#include "metrics.h"
+#include "text_chunker.h"
+#include "text_masker.h"
+#include "text_scanner.h"
+#include "translation_backend.h"
+#include "translation_batcher.h"
+
+static Counter detected_local("translator_detections_total", "Source language identifications by where the answer came from", "source=\"local\"");
+static Counter detected_cached("translator_detections_total", "Source language identifications by where the answer came from", "source=\"cache\"");
+static Counter detected_upstream("translator_detections_total", "Source language identifications by where the answer came from", "source=\"upstream\"");
+static Counter translated_cached("translator_translations_total", "Translations by outcome", "result=\"cache\"");
+static Counter translated_ok("translator_translations_total", "Translations by outcome", "result=\"ok\"");
+static Counter translated_failed("translator_translations_total", "Translations by outcome", "result=\"failed\"");
+static Counter sentences_cached("translator_sentences_total", "Sentences of sentence-level translations by where they came from", "source=\"cache\"");
+static Counter sentences_upstream("translator_sentences_total", "Sentences of sentence-level translations by where they came from", "source=\"upstream\"");
+static Counter sentence_split_failures("translator_sentence_split_failures_total", "Joined sentence translations that could not be split apart again");
+static Counter skipped_untranslatable("translator_skipped_total", "Texts that needed no upstream call", "reason=\"nothing_to_translate\"");
+static Counter skipped_same_script("translator_skipped_total", "Texts that needed no upstream call", "reason=\"same_script\"");
+static Counter masked_spans("translator_masked_spans_total", "Code, links, mentions and numbers kept out of translation");
+static Counter restore_failures("translator_restore_failures_total", "Translations that lost a placeholder and were redone unmasked");
+static Histogram detect_seconds("translator_detect_seconds", "Time to identify the source language without a translation request");
+static Histogram detect_upstream_seconds("translator_detect_upstream_seconds", "Time of detect_language() calls that had to ask the backend");
+static Histogram translate_seconds("translator_translate_seconds", "Time to translate a text into all requested targets");
+
+static std::atomic<size_t> messages_in_flight{0};
+
+TranslationCache& translation_cache() {
+    static TranslationCache cache(
+        std::max<long>(config_int("CACHE_MAX_BYTES", 32 * 1024 * 1024), 1),
+        std::chrono::seconds(std::max<long>(config_int("CACHE_TTL_SECONDS", 24 * 60 * 60), 1)));
+    return cache;
+}
+
+// Bytes that pass through url_encode unescaped (RFC 3986 unreserved characters)
+static const std::array<bool, 256> UNRESERVED = [] {
+    std::array<bool, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                   c == '-' || c == '_' || c == '.' || c == '~';
+    }
+    return table;
+}();
+
+void url_encode_into(std::string& out, std::string_view value) {
+    static const char HEX[] = "0123456789ABCDEF";
+
+    // Size the output exactly, then fill it in place
+    size_t escaped = 0;
+    for (unsigned char c : value) {
+        escaped += !UNRESERVED[c];
+    }
+    size_t start = out.size();
+    out.resize(start + value.size() + 2 * escaped);
+
+    char* dest = &out[start];
+    for (unsigned char c : value) {
+        if (UNRESERVED[c]) {
+            *dest++ = static_cast<char>(c);
+        } else {
+            *dest++ = '%';
+            *dest++ = HEX[c >> 4];
+            *dest++ = HEX[c & 0xF];
+        }
+    }
+}
+
+std::string url_encode(const std::string& value) {
+    std::string escaped;
+    url_encode_into(escaped, value);
+    return escaped;
+}
+
+bool same_language(const std::string& a, const std::string& b) {
+    if (a == b) {
+        return true;
+    }
+    // Through the registry, so aliases match ("he" and "iw") but related
+    // codes do not ("zh-CN" and "zh-TW", "ha" and "haw")
+    const Language* language = language_by_code(a);
+    return language && language == language_by_code(b);
+}
+
+// Texts sent as one request are joined with numbered marker lines ("[1]",
+// "[2]", ...) that pass through translation untouched, then split apart on
+// them again
+template <typename TextOf>
+static std::string join_marked(size_t count, TextOf text_of) {
+    std::string joined;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            joined += "\n[" + std::to_string(i) + "]\n";
+        }
+        joined += text_of(i);
+    }
+    return joined;
+}
+
+static std::string join_batch(const Batch& batch) {
+    return join_marked(batch.items.size(), [&](size_t i) -> const std::string& { return batch.items[i].text; });
+}
+
+static std::string trim_lines(const std::string& value) {
+    size_t start = value.find_first_not_of(" \n");
+    if (start == std::string::npos) {
+        return "";
+    }
+    return value.substr(start, value.find_last_not_of(" \n") - start + 1);
+}
+
+// Whether text holds a marker of a request joining count texts, such as
+// one the user typed that would shift the split
+static bool contains_marker(const std::string& text, size_t count) {
+    for (size_t open = text.find('['); open != std::string::npos; open = text.find('[', open + 1)) {
+        size_t close = text.find(']', open);
+        if (close == std::string::npos) {
+            return false;
+        }
+        size_t digits = close - open - 1;
+        if (digits == 0 || digits > 9) {
+            continue;
+        }
+        bool numeric = std::all_of(text.begin() + open + 1, text.begin() + close, [](unsigned char ch) {
+            return std::isdigit(ch);
+        });
+        if (numeric) {
+            size_t k = std::stoul(text.substr(open + 1, digits));
+            if (k >= 1 && k < count) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Markers must come back as whole lines, each once and in order. Anything
+// else (a marker moved or dropped, or one left inside a part) fails the
+// split so the texts are sent one by one instead of risking one text's
+// translation landing in another's reply.
+static bool split_marked(const std::string& translated, size_t count, std::vector<std::string>& parts) {
+    parts.clear();
+    size_t pos = 0;
+
+    for (size_t i = 1; i <= count; ++i) {
+        size_t end = translated.size();
+        size_t next = translated.size();
+        if (i < count) {
+            std::string marker = "\n[" + std::to_string(i) + "]\n";
+            end = translated.find(marker, pos);
+            if (end == std::string::npos) {
+                return false;
+            }
+            next = end + marker.size();
+        }
+
+        parts.push_back(trim_lines(translated.substr(pos, end - pos)));
+        if (parts.back().empty() || contains_marker(parts.back(), count)) {
+            return false;
+        }
+        pos = next;
+    }
+
+    return true;
+}
+
+static void flush_batches(std::vector<Batch>& batches);
+
+// Shared batcher, or nullptr when batching is disabled
+static TranslationBatcher* translation_batcher() {
+    static std::unique_ptr<TranslationBatcher> batcher = []() -> std::unique_ptr<TranslationBatcher> {
+        if (!config_bool("BATCH_ENABLED", false)) {
+            return nullptr;
+        }
+        // Construct the backend first so it outlives the batcher at exit
+        translation_backend();
+        return std::make_unique<TranslationBatcher>(
+            std::chrono::milliseconds(std::max<long>(config_int("BATCH_WINDOW_MS", 50), 0)),
+            std::max<long>(config_int("BATCH_MAX_ITEMS", 8), 1),
+            std::max<long>(config_int("BATCH_MAX_CHARS", 1500), 1),
+            flush_batches);
+    }();
+    return batcher.get();
+}
+
+static void flush_batches(std::vector<Batch>& flushed) {
+    auto batches = std::make_shared<std::vector<Batch>>(std::move(flushed));
+
+    std::vector<TranslationRequest> requests;
+    for (const auto& batch : *batches) {
+        requests.push_back({join_batch(batch), batch.source_lang, batch.target_lang});
+    }
+
+    // Items whose batch came back in a shape we could not split
+    auto retry = std::make_shared<std::vector<std::pair<size_t, size_t>>>();
+
+    auto on_complete = [batches, retry](size_t i, TranslationResult& result) {
+        const Batch& batch = (*batches)[i];
+
+        std::vector<std::string> parts;
+        if (result.ok && batch.items.size() == 1) {
+            batch.items[0].done(result.text);
+        } else if (result.ok && split_marked(result.text, batch.items.size(), parts)) {
+            for (size_t k = 0; k < parts.size(); ++k) {
+                batch.items[k].done(parts[k]);
+            }
+        } else if (result.ok) {
+            translation_batcher()->record_split_failure();
+            for (size_t k = 0; k < batch.items.size(); ++k) {
+                retry->emplace_back(i, k);
+            }
+        } else {
+            for (const auto& item : batch.items) {
+                item.done("");
+            }
+        }
+    };
+
+    // Fall back to one request per text
+    auto on_done = [batches, retry]() {
+        if (retry->empty()) {
+            return;
+        }
+
+        std::vector<TranslationRequest> singles;
+        for (const auto& [i, k] : *retry) {
+            const Batch& batch = (*batches)[i];
+            singles.push_back({batch.items[k].text, batch.source_lang, batch.target_lang});
+        }
+        translation_backend().translate_async(std::move(singles), [batches, retry](size_t j, TranslationResult& result) {
+            const auto& [i, k] = (*retry)[j];
+            (*batches)[i].items[k].done(result.ok ? result.text : "");
+        });
+    };
+
+    translation_backend().translate_async(std::move(requests), on_complete, on_done);
+}
+
+BatchStats translation_batch_stats() {
+    TranslationBatcher* batcher = translation_batcher();
+    return batcher ? batcher->stats() : BatchStats();
+}
+
+void warm_up_translator() {
+    translation_cache();
+    translation_batcher();
+    detect_language_local(std::string("warm up the detector models"));
+}
+
+// Source language known without asking upstream, or "" if unsure
+static std::string known_language(const TextScan& scan, const std::string& cleaned) {
+    // Answer locally when the offline detector is confident enough
+    static const double local_threshold = config_double("LOCAL_DETECT_THRESHOLD", 0.9);
+    LanguageGuess guess = detect_language_local(scan);
+    if (!guess.code.empty() && guess.confidence >= local_threshold) {
+        detected_local.add();
+        return guess.code;
+    }
+
+    std::string cached;
+    if (translation_cache().get(cleaned, "auto", "", cached)) {
+        detected_cached.add();
+        return cached;
+    }
+    return "";
+}
+
+// True if text has a letter in any script
+static bool has_letters(const std::string& text) {
+    for (size_t i = 0; i < text.size();) {
+        uint32_t cp = 0;
+        size_t length = decode_utf8(text, i, cp);
+        if (length == 0) {
+            ++i;
+            continue;
+        }
+        if (script_of(cp) != Script::Count) {
+            return true;
+        }
+        i += length;
+    }
+    return false;
+}
+
+void detect_language_async(const std::string& text, std::function<void(const std::string&)> on_done) {
+    auto start = std::chrono::steady_clock::now();
+    MaskedText masked = mask_spans(text);
+    TextScan scan = scan_text(masked.text);
+    std::string cleaned = scan.cleaned.empty() ? masked.text : scan.cleaned;
+
+    std::string known = known_language(scan, cleaned);
+    detect_seconds.observe(std::chrono::steady_clock::now() - start);
+    if (!known.empty()) {
+        on_done(known);
+        return;
+    }
+    if (scan.letters() == 0) {
+        // Nothing upstream could recognize
+        skipped_untranslatable.add();
+        on_done("en");
+        return;
+    }
+
+    translation_backend().translate_async({{cleaned, "auto", "en"}},
+        [start, cleaned, on_done = std::move(on_done)](size_t, TranslationResult& result) {
+            detect_upstream_seconds.observe(std::chrono::steady_clock::now() - start);
+            if (result.detected_lang.empty()) {
+                on_done("en");
+                return;
+            }
+            detected_upstream.add();
+            translation_cache().put(cleaned, "auto", "", result.detected_lang);
+            on_done(result.detected_lang);
+        });
+}
+
+std::string detect_language(const std::string& text) {
+    auto detected = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> result = detected->get_future();
+    detect_language_async(text, [detected](const std::string& lang) { detected->set_value(lang); });
+    return result.get();
+}
+
+// Translate text using the configured backend
+std::string translate_text(const std::string& text, const std::string& source_lang, const std::string& target_lang) {
+    MaskedText masked = mask_spans(text);
+    masked_spans.add(masked.spans.size());
+    if (!has_letters(masked.text)) {
+        skipped_untranslatable.add();
+        return text;
+    }
+
+    std::string cached;
+    std::string restored;
+    if (translation_cache().get(masked.text, source_lang, target_lang, cached) && unmask_spans(cached, masked, restored)) {
+        translated_cached.add();
+        return restored;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TranslationResult result = translation_backend().translate({masked.text, source_lang, target_lang});
+    if (result.ok && !unmask_spans(result.text, masked, restored)) {
+        // A placeholder got lost: send the text as written instead
+        restore_failures.add();
+        result = translation_backend().translate({text, source_lang, target_lang});
+        translate_seconds.observe(std::chrono::steady_clock::now() - start);
+        (result.ok ? translated_ok : translated_failed).add();
+        return result.ok ? result.text : "";
+    }
+    translate_seconds.observe(std::chrono::steady_clock::now() - start);
+    if (!result.ok) {
+        translated_failed.add();
+        return "";
+    }
+    translated_ok.add();
+
+    translation_cache().put(masked.text, source_lang, target_lang, result.text);
+    return restored;
+}
+
+namespace {
+
+// One translate_message_async call. Everything after the cached targets
+// runs on the event loop thread, so the fields need no lock.
+struct MessageJob {
+    std::string original;
+    MaskedText masked;  // What goes upstream, and the cache key
+    std::string cleaned;
+    std::string source;  // Known before any request went out, or ""
+    std::vector<std::string> targets;
+    std::vector<std::string> pending;
+    std::map<std::string, std::string> finished;
+    MessageTranslation result;
+    TranslationCallback on_translation;
+    MessageCallback on_done;
+    std::chrono::steady_clock::time_point detected_at = std::chrono::steady_clock::now();
+    size_t remaining = 0;
+
+    // Take note of the source upstream detected for a sl=auto request.
+    // Returns false if the reply holds no usable translation into target.
+    bool accept_source(const std::string& detected, const std::string& target) {
+        if (!source.empty()) {
+            return true;
+        }
+        if (detected.empty()) {
+            return false;
+        }
+        if (result.source_lang.empty()) {
+            detected_upstream.add();
+            result.source_lang = detected;
+            translation_cache().put(cleaned, "auto", "", detected);
+        }
+        // The text was already in this target language
+        return !same_language(detected, target);
+    }
+
+    // Finish right away if no upstream call is needed: nothing is left but
+    // code, links, mentions and numbers, which are their own translation,
+    // or the text is written in a script only the targets' language uses
+    bool finish_early(const TextScan& scan) {
+        if (scan.letters() == 0) {
+            skipped_untranslatable.add();
+            for (const auto& target : targets) {
+                deliver(target, original);
+            }
+            finish();
+            return true;
+        }
+
+        std::string written_in = script_language(scan);
+        if (written_in.empty()) {
+            return false;
+        }
+        for (const auto& target : targets) {
+            if (!same_language(written_in, target)) {
+                return false;
+            }
+        }
+        skipped_same_script.add();
+        result.source_lang = written_in;
+        finish();
+        return true;
+    }
+
+    void deliver(const std::string& target, const std::string& translated) {
+        finished[target] = translated;
+        if (on_translation) {
+            on_translation(result.source_lang, Translation{target, translated});
+        }
+    }
+
+    void finish() {
+        auto translated_at = std::chrono::steady_clock::now();
+        result.translate_time = std::chrono::duration_cast<std::chrono::microseconds>(translated_at - detected_at);
+        if (!pending.empty()) {
+            translate_seconds.observe(translated_at - detected_at);
+        }
+
+        if (result.source_lang.empty()) {
+            result.source_lang = "en";
+        }
+
+        for (const auto& target : targets) {
+            auto it = finished.find(target);
+            if (it != finished.end()) {
+                result.translations.push_back({target, it->second});
+            }
+        }
+
+        messages_in_flight.fetch_sub(1, std::memory_order_relaxed);
+        if (on_done) {
+            on_done(result);
+        }
+    }
+};
+
+}  // namespace
+
+size_t translations_in_flight() {
+    return messages_in_flight.load(std::memory_order_relaxed);
+}
+
+// Translate the original, unmasked text into the pending targets at
+// indexes, after their placeholders did not survive translation
+static void translate_unmasked(const std::shared_ptr<MessageJob>& job, std::vector<size_t> indexes,
+                               std::function<void()> next) {
+    if (indexes.empty()) {
+        next();
+        return;
+    }
+
+    std::vector<TranslationRequest> requests;
+    for (size_t i : indexes) {
+        requests.push_back({job->original, job->source.empty() ? "auto" : job->source, job->pending[i]});
+    }
+    auto targets = std::make_shared<std::vector<size_t>>(std::move(indexes));
+    translation_backend().translate_async(std::move(requests), [job, targets](size_t j, TranslationResult& reply) {
+        (reply.ok ? translated_ok : translated_failed).add();
+        const std::string& target = job->pending[(*targets)[j]];
+        if (reply.ok && job->accept_source(reply.detected_lang, target)) {
+            job->deliver(target, reply.text);
+        }
+    }, std::move(next));
+}
+
+void translate_message_async(const std::string& text, const std::vector<std::string>& target_langs,
+                             TranslationCallback on_translation, MessageCallback on_done) {
+    messages_in_flight.fetch_add(1, std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+
+    auto job = std::make_shared<MessageJob>();
+    job->original = text;
+    job->masked = mask_spans(text);
+    job->targets = target_langs;
+    job->on_translation = std::move(on_translation);
+    job->on_done = std::move(on_done);
+    masked_spans.add(job->masked.spans.size());
+    const std::string& masked = job->masked.text;
+
+    TextScan scan = scan_text(masked);
+    if (job->finish_early(scan)) {
+        return;
+    }
+    job->cleaned = scan.cleaned.empty() ? masked : scan.cleaned;
+    job->source = known_language(scan, job->cleaned);
+    job->result.source_lang = job->source;
+    const std::string& source = job->source;
+
+    job->detected_at = std::chrono::steady_clock::now();
+    job->result.detect_time = std::chrono::duration_cast<std::chrono::microseconds>(job->detected_at - start);
+    detect_seconds.observe(job->detected_at - start);
+
+    std::vector<TranslationRequest> requests;
+    for (const auto& target : target_langs) {
+        if (!source.empty() && same_language(source, target)) {
+            continue;
+        }
+
+        std::string cached;
+        std::string restored;
+        if (!source.empty() && translation_cache().get(masked, source, target, cached) &&
+            unmask_spans(cached, job->masked, restored)) {
+            translated_cached.add();
+            job->deliver(target, restored);
+            continue;
+        }
+
+        job->pending.push_back(target);
+        requests.push_back({masked, source.empty() ? "auto" : source, target});
+    }
+
+    if (job->pending.empty()) {
+        job->finish();
+        return;
+    }
+
+    TranslationBatcher* batcher = translation_batcher();
+    if (batcher && !source.empty()) {
+        // Hand the texts to the batcher; its flushes complete them on the event loop
+        job->remaining = job->pending.size();
+        for (size_t i = 0; i < job->pending.size(); ++i) {
+            batcher->submit(source, job->pending[i], masked, [job, i](const std::string& translated) {
+                (translated.empty() ? translated_failed : translated_ok).add();
+                auto next = [job]() {
+                    if (--job->remaining == 0) {
+                        job->finish();
+                    }
+                };
+
+                std::string restored;
+                if (!translated.empty() && !unmask_spans(translated, job->masked, restored)) {
+                    restore_failures.add();
+                    translate_unmasked(job, {i}, next);
+                    return;
+                }
+                if (!translated.empty()) {
+                    translation_cache().put(job->masked.text, job->source, job->pending[i], translated);
+                    job->deliver(job->pending[i], restored);
+                }
+                next();
+            });
+        }
+        return;
+    }
+
+    auto retry = std::make_shared<std::vector<size_t>>();
+    translation_backend().translate_async(std::move(requests), [job, retry](size_t i, TranslationResult& reply) {
+        if (!reply.ok) {
+            translated_failed.add();
+            return;
+        }
+        translated_ok.add();
+        const std::string& target = job->pending[i];
+        if (!job->accept_source(reply.detected_lang, target)) {
+            return;
+        }
+
+        std::string restored;
+        if (!unmask_spans(reply.text, job->masked, restored)) {
+            restore_failures.add();
+            retry->push_back(i);
+            return;
+        }
+        translation_cache().put(job->masked.text, job->source.empty() ? reply.detected_lang : job->source, target,
+                                reply.text);
+        job->deliver(target, restored);
+    }, [job, retry]() {
+        translate_unmasked(job, std::move(*retry), [job]() { job->finish(); });
+    });
+}
+
+namespace {
+
+// One translate_sentences_async call. Each sentence is masked on its own,
+// so its cache entry doesn't depend on what surrounds it. pending holds the
+// targets that had sentences to send upstream, with their sentences in
+// translated and the indexes of those still missing in missing.
+struct SentenceJob : MessageJob {
+    std::vector<TextChunk> pieces;
+    std::vector<size_t> sentences;  // Indexes of the translatable pieces
+    std::vector<MaskedText> masked_sentences;
+    std::vector<std::vector<std::string>> translated;
+    std::vector<std::vector<size_t>> missing;
+
+    const std::string& sentence(size_t k) const { return masked_sentences[k].text; }
+    const std::string& raw_sentence(size_t k) const { return pieces[sentences[k]].text; }
+
+    std::string assemble(const std::vector<std::string>& parts) const {
+        std::string out;
+        size_t k = 0;
+        for (const auto& piece : pieces) {
+            out += piece.translate ? parts[k++] : piece.text;
+        }
+        return out;
+    }
+
+    // Store the translation of sentence k for pending target t. Returns
+    // false if its placeholders did not survive.
+    bool fill(size_t t, size_t k, const std::string& lang, const std::string& translation) {
+        if (!unmask_spans(translation, masked_sentences[k], translated[t][k])) {
+            restore_failures.add();
+            translated[t][k].clear();
+            return false;
+        }
+        if (lang != "auto") {
+            translation_cache().put(sentence(k), lang, pending[t], translation);
+        }
+        return true;
+    }
+
+    bool complete(size_t t) const {
+        for (const auto& part : translated[t]) {
+            if (part.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+using SentenceSlots = std::vector<std::pair<size_t, size_t>>;  // (pending target, sentence)
+
+}  // namespace
+
+// Send the sentences in retry one by one as written, after their joined
+// reply could not be split apart or lost a placeholder
+static void retry_sentences(const std::shared_ptr<SentenceJob>& job, std::shared_ptr<SentenceSlots> retry) {
+    std::string lang = job->source.empty() ? job->result.source_lang : job->source;
+    if (lang.empty()) {
+        lang = "auto";
+    }
+
+    std::vector<TranslationRequest> singles;
+    for (const auto& [t, k] : *retry) {
+        singles.push_back({job->raw_sentence(k), lang, job->pending[t]});
+    }
+
+    translation_backend().translate_async(std::move(singles), [job, retry](size_t j, TranslationResult& reply) {
+        (reply.ok ? translated_ok : translated_failed).add();
+        if (reply.ok) {
+            const auto& [t, k] = (*retry)[j];
+            job->translated[t][k] = std::move(reply.text);
+        }
+    }, [job, retry]() {
+        std::vector<bool> seen(job->pending.size());
+        for (const auto& [t, k] : *retry) {
+            if (!seen[t] && job->complete(t)) {
+                job->deliver(job->pending[t], job->assemble(job->translated[t]));
+            }
+            seen[t] = true;
+        }
+        job->finish();
+    });
+}
+
+void translate_sentences_async(const std::string& text, const std::string& source_hint,
+                               const std::vector<std::string>& target_langs,
+                               TranslationCallback on_translation, MessageCallback on_done) {
+    messages_in_flight.fetch_add(1, std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+
+    auto job = std::make_shared<SentenceJob>();
+    job->original = text;
+    job->targets = target_langs;
+    job->on_translation = std::move(on_translation);
+    job->on_done = std::move(on_done);
+
+    // The masked sentences, and all of them together for detection
+    job->pieces = split_sentences(text);
+    for (size_t i = 0; i < job->pieces.size(); ++i) {
+        if (job->pieces[i].translate) {
+            job->sentences.push_back(i);
+            job->masked_sentences.push_back(mask_spans(job->pieces[i].text));
+            masked_spans.add(job->masked_sentences.back().spans.size());
+            if (!job->masked.text.empty()) {
+                job->masked.text += ' ';
+            }
+            job->masked.text += job->masked_sentences.back().text;
+        }
+    }
+
+    TextScan scan = scan_text(job->masked.text);
+    if (job->finish_early(scan)) {
+        return;
+    }
+    job->cleaned = scan.cleaned.empty() ? job->masked.text : scan.cleaned;
+    job->source = known_language(scan, job->cleaned);
+    if (job->source.empty()) {
+        job->source = source_hint;
+    }
+    job->result.source_lang = job->source;
+    const std::string& source = job->source;
+
+    job->detected_at = std::chrono::steady_clock::now();
+    job->result.detect_time = std::chrono::duration_cast<std::chrono::microseconds>(job->detected_at - start);
+    detect_seconds.observe(job->detected_at - start);
+
+    // With a known source, sentences go through the batcher to share
+    // requests with other messages' sentences for the same language pair
+    TranslationBatcher* batcher = source.empty() ? nullptr : translation_batcher();
+
+    std::vector<TranslationRequest> requests;
+    for (const auto& target : target_langs) {
+        if (!source.empty() && same_language(source, target)) {
+            continue;
+        }
+
+        std::vector<std::string> translated(job->sentences.size());
+        std::vector<size_t> missing;
+        for (size_t k = 0; k < translated.size(); ++k) {
+            std::string cached;
+            if (!has_letters(job->sentence(k))) {
+                // A line of links or numbers is its own translation
+                translated[k] = job->raw_sentence(k);
+            } else if (source.empty() || !translation_cache().get(job->sentence(k), source, target, cached) ||
+                       !unmask_spans(cached, job->masked_sentences[k], translated[k])) {
+                translated[k].clear();
+                missing.push_back(k);
+            } else {
+                sentences_cached.add();
+            }
+        }
+
+        if (missing.empty()) {
+            translated_cached.add();
+            job->deliver(target, job->assemble(translated));
+            continue;
+        }
+
+        // Only the sentences not seen before go upstream, as one request
+        sentences_upstream.add(missing.size());
+        if (!batcher) {
+            requests.push_back({join_marked(missing.size(), [&](size_t m) -> const std::string& {
+                return job->sentence(missing[m]);
+            }), source.empty() ? "auto" : source, target});
+        }
+        job->pending.push_back(target);
+        job->translated.push_back(std::move(translated));
+        job->missing.push_back(std::move(missing));
+    }
+
+    if (job->pending.empty()) {
+        job->finish();
+        return;
+    }
+
+    auto retry = std::make_shared<SentenceSlots>();
+    if (batcher) {
+        // Its flushes complete the sentences on the event loop
+        for (const auto& missing : job->missing) {
+            job->remaining += missing.size();
+        }
+        for (size_t t = 0; t < job->pending.size(); ++t) {
+            for (size_t k : job->missing[t]) {
+                batcher->submit(source, job->pending[t], job->sentence(k),
+                                [job, retry, t, k](const std::string& translated) {
+                    (translated.empty() ? translated_failed : translated_ok).add();
+                    if (!translated.empty()) {
+                        if (!job->fill(t, k, job->source, translated)) {
+                            retry->emplace_back(t, k);
+                        } else if (job->complete(t)) {
+                            job->deliver(job->pending[t], job->assemble(job->translated[t]));
+                        }
+                    }
+                    if (--job->remaining == 0) {
+                        if (retry->empty()) {
+                            job->finish();
+                        } else {
+                            retry_sentences(job, retry);
+                        }
+                    }
+                });
+            }
+        }
+        return;
+    }
+
+    translation_backend().translate_async(std::move(requests), [job, retry](size_t t, TranslationResult& reply) {
+        if (!reply.ok) {
+            translated_failed.add();
+            return;
+        }
+        translated_ok.add();
+        if (!job->accept_source(reply.detected_lang, job->pending[t])) {
+            return;
+        }
+
+        const std::vector<size_t>& missing = job->missing[t];
+        std::vector<std::string> parts;
+        if (missing.size() == 1) {
+            parts.push_back(std::move(reply.text));
+        } else if (!split_marked(reply.text, missing.size(), parts)) {
+            sentence_split_failures.add();
+            for (size_t k : missing) {
+                retry->emplace_back(t, k);
+            }
+            return;
+        }
+
+        const std::string& lang = job->source.empty() ? reply.detected_lang : job->source;
+        bool restored = true;
+        for (size_t m = 0; m < missing.size(); ++m) {
+            if (!job->fill(t, missing[m], lang, parts[m])) {
+                retry->emplace_back(t, missing[m]);
+                restored = false;
+            }
+        }
+        if (restored) {
+            job->deliver(job->pending[t], job->assemble(job->translated[t]));
+        }
+    }, [job, retry]() {
+        if (retry->empty()) {
+            job->finish();
+        } else {
+            retry_sentences(job, retry);
+        }
+    });
+}
+
+MessageTranslation translate_message(const std::string& text, const std::vector<std::string>& target_langs,
+                                     const TranslationCallback& on_translation) {
+    auto finished = std::make_shared<std::promise<MessageTranslation>>();
+    std::future<MessageTranslation> result = finished->get_future();
+    translate_message_async(text, target_langs, on_translation, [finished](MessageTranslation& done) {
+        finished->set_value(std::move(done));
+    });
+    return result.get();
+}
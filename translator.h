@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "translation_batcher.h"
+#include "translation_cache.h"
+
+// Cache of detection and translation results
+TranslationCache& translation_cache();
+
+// Percent-encode everything but RFC 3986 unreserved characters
+std::string url_encode(const std::string& value);
+
+// Append the percent-encoded value to out, growing it once
+void url_encode_into(std::string& out, std::string_view value);
+
+// True if two language codes refer to the same language (e.g. "zh-CN" and
+// "zh", "iw" and "he"); codes the registry does not know must match exactly
+bool same_language(const std::string& a, const std::string& b);
+
+// Upstream batching counters (all zero when BATCH_ENABLED is off)
+BatchStats translation_batch_stats();
+
+// Build the offline detector's models, the cache and the batcher now rather
+// than on the first message. Takes a few milliseconds; call it off the event
+// loop. Connecting to the backend is translation_backend().warm_up().
+void warm_up_translator();
+
+// Detect the language of text, falling back to "en" if detection fails.
+// on_done runs right away when the offline detector or the cache knows the
+// answer, otherwise on the event loop thread once upstream has replied.
+void detect_language_async(const std::string& text, std::function<void(const std::string&)> on_done);
+
+// Blocking form of detect_language_async. Never call it on the event loop thread.
+std::string detect_language(const std::string& text);
+
+// Translate text, returning "" on failure
+std::string translate_text(const std::string& text, const std::string& source_lang, const std::string& target_lang);
+
+struct Translation {
+    std::string target_lang;
+    std::string text;
+};
+
+struct MessageTranslation {
+    std::string source_lang;
+    std::vector<Translation> translations;  // In the order of the requested targets
+
+    // Time spent identifying the source locally, and on the translations
+    // themselves (which include upstream detection when sl=auto was needed)
+    std::chrono::microseconds detect_time{0};
+    std::chrono::microseconds translate_time{0};
+};
+
+// Called once for every translation as soon as it is available
+using TranslationCallback = std::function<void(const std::string& source_lang, const Translation& translation)>;
+
+// Called once when every target has been translated or has failed
+using MessageCallback = std::function<void(MessageTranslation& result)>;
+
+// Detect the language of text and translate it into every target language
+// that differs from it. Requests for all targets are issued concurrently.
+// If the offline detector is unsure, each request asks upstream to detect
+// the source (sl=auto), so detection costs no extra round trip.
+//
+// Returns once the requests are started. Cached translations are delivered
+// on the calling thread before it returns; everything else, including
+// on_done, runs on the event loop thread and must not block.
+void translate_message_async(const std::string& text, const std::vector<std::string>& target_langs,
+                             TranslationCallback on_translation, MessageCallback on_done);
+
+// Like translate_message_async, but the text is translated sentence by
+// sentence: sentences translated before (in an earlier version of an edited
+// message, say) come from the cache, and only the rest go upstream, joined
+// into one request per target. source_hint is used when the source cannot
+// be identified locally, so a known language keeps the cache usable.
+void translate_sentences_async(const std::string& text, const std::string& source_hint,
+                               const std::vector<std::string>& target_langs,
+                               TranslationCallback on_translation, MessageCallback on_done);
+
+// Blocking form of translate_message_async. Never call it on the event loop thread.
+MessageTranslation translate_message(const std::string& text, const std::vector<std::string>& target_langs,
+                                     const TranslationCallback& on_translation = nullptr);
+
+// translate_message_async calls that have not finished yet
+size_t translations_in_flight();
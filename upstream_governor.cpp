@@ -0,0 +1,215 @@
+#include "upstream_governor.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "config.h"
+#include "event_loop.h"
+#include "metrics.h"
+
+static Counter upstream_rejected("upstream_rejected_total", "Requests refused by the upstream governor");
+static Counter upstream_retries("upstream_retries_total", "Requests retried after a retryable failure");
+static Counter circuit_opened("upstream_circuit_opened_total", "Times the upstream circuit breaker opened");
+static Histogram token_wait("upstream_token_wait_seconds", "Time requests waited for a rate limit token");
+
+// Healthy responses raise the rate by this many requests per second each
+static const double RATE_STEP = 0.2;
+
+// Rate reductions are spaced out so one burst of 429s counts once
+static const std::chrono::seconds SLOWDOWN_INTERVAL(1);
+
+// Configured rates are raised to this so waiting for a token always ends
+static const double LOWEST_RATE = 0.01;
+
+UpstreamGovernor::UpstreamGovernor(GovernorOptions options)
+    : options_(options),
+      rate_(options.max_rate),
+      tokens_(options.burst),
+      refilled_at_(std::chrono::steady_clock::now()) {}
+
+void UpstreamGovernor::refill(std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - refilled_at_).count();
+    tokens_ = std::min(options_.burst, tokens_ + elapsed * rate_);
+    refilled_at_ = now;
+}
+
+void UpstreamGovernor::slow_down(double factor, std::chrono::steady_clock::time_point now) {
+    if (now - slowed_at_ < SLOWDOWN_INTERVAL) {
+        return;
+    }
+    rate_ = std::max(options_.min_rate, rate_ * factor);
+    slowed_at_ = now;
+}
+
+bool UpstreamGovernor::admit(std::chrono::steady_clock::duration& wait) {
+    wait = std::chrono::steady_clock::duration::zero();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+
+        if (circuit_ == Circuit::Open && now - opened_at_ >= options_.breaker_cooldown) {
+            circuit_ = Circuit::HalfOpen;
+        }
+        if (circuit_ == Circuit::Open || (circuit_ == Circuit::HalfOpen && probe_in_flight_)) {
+            ++rejected_;
+            upstream_rejected.add();
+            return false;
+        }
+
+        // Reserve a token now, possibly going into debt; the caller waits out the debt
+        refill(now);
+        if (tokens_ < 1.0) {
+            wait = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>((1.0 - tokens_) / rate_));
+            if (wait > options_.max_wait) {
+                ++rejected_;
+                upstream_rejected.add();
+                return false;
+            }
+        }
+        tokens_ -= 1.0;
+
+        if (circuit_ == Circuit::HalfOpen) {
+            probe_in_flight_ = true;
+        }
+        ++admitted_;
+    }
+
+    token_wait.observe(wait);
+    return true;
+}
+
+void UpstreamGovernor::record(long status, bool ok, std::chrono::steady_clock::duration latency) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+
+    if (status == 429) {
+        ++rate_limited_;
+        slow_down(0.5, now);
+    } else if (latency > options_.target_latency) {
+        slow_down(0.9, now);
+    } else if (ok) {
+        rate_ = std::min(options_.max_rate, rate_ + RATE_STEP);
+    }
+
+    bool failed = !ok && retryable(status);
+    if (circuit_ == Circuit::HalfOpen) {
+        probe_in_flight_ = false;
+        if (failed) {
+            circuit_ = Circuit::Open;
+            opened_at_ = now;
+            return;
+        }
+        circuit_ = Circuit::Closed;
+        consecutive_failures_ = 0;
+        std::cerr << "Translation backend recovered" << std::endl;
+    }
+
+    if (!failed) {
+        consecutive_failures_ = 0;
+        return;
+    }
+
+    if (++consecutive_failures_ >= options_.breaker_failures && circuit_ == Circuit::Closed) {
+        circuit_ = Circuit::Open;
+        opened_at_ = now;
+        circuit_opened.add();
+        std::cerr << "Translation backend unhealthy, pausing requests for "
+                  << options_.breaker_cooldown.count() << "s" << std::endl;
+    }
+}
+
+bool UpstreamGovernor::healthy() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return circuit_ != Circuit::Open ||
+           std::chrono::steady_clock::now() - opened_at_ >= options_.breaker_cooldown;
+}
+
+std::chrono::milliseconds UpstreamGovernor::backoff(int attempt) {
+    // Full jitter: anywhere between zero and the exponential ceiling
+    auto ceiling = std::min(options_.retry_cap, options_.retry_base * (1 << std::min(attempt, 16)));
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uniform_int_distribution<long> pick(0, ceiling.count());
+    return std::chrono::milliseconds(pick(rng_));
+}
+
+void UpstreamGovernor::count_retry() {
+    upstream_retries.add();
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++retries_;
+}
+
+GovernorStats UpstreamGovernor::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    GovernorStats s;
+    s.rate = rate_;
+    s.circuit = circuit_ == Circuit::Closed ? "closed" : circuit_ == Circuit::Open ? "open" : "half-open";
+    s.admitted = admitted_;
+    s.rejected = rejected_;
+    s.retries = retries_;
+    s.rate_limited = rate_limited_;
+    return s;
+}
+
+GovernedBackend::GovernedBackend(std::unique_ptr<TranslationBackend> inner, UpstreamGovernor& governor)
+    : inner_(std::move(inner)), governor_(governor) {}
+
+void GovernedBackend::translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                                      DoneFunction on_done) {
+    auto pending = PendingRequests::start(requests.size(), std::move(on_complete), std::move(on_done));
+    for (size_t i = 0; i < requests.size(); ++i) {
+        send(pending, i, std::move(requests[i]), 0);
+    }
+}
+
+void GovernedBackend::send(std::shared_ptr<PendingRequests> pending, size_t index, TranslationRequest request,
+                           int attempt) {
+    std::chrono::steady_clock::duration wait;
+    if (!governor_.admit(wait)) {
+        event_loop().post([pending, index]() {
+            TranslationResult refused;
+            pending->complete(index, refused);
+        });
+        return;
+    }
+
+    event_loop().post_after(wait, [this, pending, index, request, attempt]() {
+        auto start = std::chrono::steady_clock::now();
+        inner_->translate_async({request}, [=](size_t, TranslationResult& result) {
+            governor_.record(result.status, result.ok, std::chrono::steady_clock::now() - start);
+
+            if (!result.ok && UpstreamGovernor::retryable(result.status) &&
+                attempt < governor_.options().max_retries) {
+                governor_.count_retry();
+                event_loop().post_after(governor_.backoff(attempt), [=]() {
+                    send(pending, index, request, attempt + 1);
+                });
+                return;
+            }
+            pending->complete(index, result);
+        });
+    });
+}
+
+UpstreamGovernor& upstream_governor() {
+    static UpstreamGovernor governor([] {
+        GovernorOptions options;
+        options.max_rate = std::max(config_double("UPSTREAM_MAX_RATE", options.max_rate), LOWEST_RATE);
+        options.min_rate =
+            std::clamp(config_double("UPSTREAM_MIN_RATE", options.min_rate), LOWEST_RATE, options.max_rate);
+        options.burst = std::max(config_double("UPSTREAM_BURST", options.max_rate), 1.0);
+        options.max_wait =
+            std::chrono::milliseconds(std::max<long>(config_int("UPSTREAM_MAX_WAIT_MS", options.max_wait.count()), 0));
+        options.target_latency = std::chrono::milliseconds(
+            std::max<long>(config_int("UPSTREAM_TARGET_LATENCY_MS", options.target_latency.count()), 1));
+        options.max_retries = std::max<long>(config_int("UPSTREAM_MAX_RETRIES", options.max_retries), 0);
+        options.retry_base = std::chrono::milliseconds(
+            std::max<long>(config_int("UPSTREAM_RETRY_BASE_MS", options.retry_base.count()), 0));
+        options.breaker_failures = std::max<long>(config_int("UPSTREAM_BREAKER_FAILURES", options.breaker_failures), 1);
+        options.breaker_cooldown = std::chrono::seconds(
+            std::max<long>(config_int("UPSTREAM_BREAKER_COOLDOWN_SECONDS", options.breaker_cooldown.count()), 0));
+        return options;
+    }());
+    return governor;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "translation_backend.h"
+
+struct GovernorOptions {
+    double max_rate = 50.0;  // Requests per second when upstream is healthy
+    double min_rate = 1.0;   // Floor the rate never drops below
+    double burst = 50.0;     // Requests that may go out back to back
+    std::chrono::milliseconds max_wait{2000};         // Longest a request waits for a token
+    std::chrono::milliseconds target_latency{1500};   // Slower responses reduce the rate
+    int max_retries = 2;
+    std::chrono::milliseconds retry_base{250};
+    std::chrono::milliseconds retry_cap{2000};
+    int breaker_failures = 5;                          // Consecutive failures that open the circuit
+    std::chrono::seconds breaker_cooldown{30};         // How long it stays open before a probe
+};
+
+struct GovernorStats {
+    double rate = 0.0;
+    const char* circuit = "closed";
+    uint64_t admitted = 0;
+    uint64_t rejected = 0;
+    uint64_t retries = 0;
+    uint64_t rate_limited = 0;
+};
+
+// Decides when requests may go upstream. A token bucket paces requests and
+// adapts its rate: 429s halve it, slow responses trim it, and healthy
+// responses raise it again step by step. A circuit breaker stops traffic
+// entirely after repeated failures and lets a single probe through once the
+// cooldown has passed.
+class UpstreamGovernor {
+public:
+    explicit UpstreamGovernor(GovernorOptions options);
+
+    // Reserve permission to send one request once wait has passed. Returns
+    // false if the circuit is open or the wait would exceed max_wait.
+    bool admit(std::chrono::steady_clock::duration& wait);
+
+    // Report the outcome of an admitted request
+    void record(long status, bool ok, std::chrono::steady_clock::duration latency);
+
+    // False while the circuit is open
+    bool healthy();
+
+    // Randomized delay before retry number attempt (0-based)
+    std::chrono::milliseconds backoff(int attempt);
+
+    static bool retryable(long status) { return status == 0 || status == 429 || status >= 500; }
+
+    const GovernorOptions& options() const { return options_; }
+    void count_retry();
+    GovernorStats stats();
+
+private:
+    enum class Circuit { Closed, Open, HalfOpen };
+
+    void refill(std::chrono::steady_clock::time_point now);
+    void slow_down(double factor, std::chrono::steady_clock::time_point now);
+
+    const GovernorOptions options_;
+
+    std::mutex mutex_;
+    double rate_;
+    double tokens_;
+    std::chrono::steady_clock::time_point refilled_at_;
+    std::chrono::steady_clock::time_point slowed_at_;
+
+    Circuit circuit_ = Circuit::Closed;
+    int consecutive_failures_ = 0;
+    bool probe_in_flight_ = false;
+    std::chrono::steady_clock::time_point opened_at_;
+
+    std::mt19937 rng_{std::random_device{}()};
+
+    uint64_t admitted_ = 0;
+    uint64_t rejected_ = 0;
+    uint64_t retries_ = 0;
+    uint64_t rate_limited_ = 0;
+};
+
+// Backend wrapper that sends every request through a governor and retries
+// retryable failures with exponential backoff and full jitter. Token waits
+// and backoff delays are event loop timers, so no thread sleeps on them.
+class GovernedBackend : public TranslationBackend {
+public:
+    GovernedBackend(std::unique_ptr<TranslationBackend> inner, UpstreamGovernor& governor);
+
+    const char* name() const override { return inner_->name(); }
+    void translate_async(std::vector<TranslationRequest> requests, CompletionFunction on_complete,
+                         DoneFunction on_done = nullptr) override;
+    void warm_up(WarmUpFunction on_done) override { inner_->warm_up(std::move(on_done)); }
+
+private:
+    void send(std::shared_ptr<PendingRequests> pending, size_t index, TranslationRequest request, int attempt);
+
+    std::unique_ptr<TranslationBackend> inner_;
+    UpstreamGovernor& governor_;
+};
+
+// Process-wide governor configured from the UPSTREAM_* options
+UpstreamGovernor& upstream_governor();
@@ -0,0 +1,168 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "metrics.h"
+
+static Histogram interactive_wait("worker_queue_wait_seconds", "Time tasks spend queued before a worker picks them up", "class=\"interactive\"");
+static Histogram auto_translate_wait("worker_queue_wait_seconds", "Time tasks spend queued before a worker picks them up", "class=\"auto_translate\"");
+static Counter tasks_dropped("worker_tasks_dropped_total", "Tasks shed because the queue was full");
+
+OverflowPolicy parse_overflow_policy(const std::string& name) {
+    if (name == "drop_oldest") {
+        return OverflowPolicy::DropOldest;
+    }
+    if (name == "drop_newest") {
+        return OverflowPolicy::DropNewest;
+    }
+    return OverflowPolicy::ShedAutoTranslate;
+}
+
+WorkerPool::WorkerPool(size_t threads, size_t queue_capacity, OverflowPolicy policy)
+    : queue_capacity_(std::max<size_t>(queue_capacity, 1)), policy_(policy) {
+    threads = std::max<size_t>(threads, 1);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&WorkerPool::worker_loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::submit(TaskClass task_class, std::function<void()> task, std::function<void()> on_drop) {
+    Task incoming{task_class, std::move(task), std::move(on_drop), std::chrono::steady_clock::now()};
+    std::function<void()> dropped_callback;
+    bool accepted = true;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) {
+            // Rejected like a shed task, so whatever it holds is released
+            lock.unlock();
+            if (incoming.on_drop) {
+                incoming.on_drop();
+            }
+            return false;
+        }
+
+        ++submitted_;
+
+        if (queue_.size() >= queue_capacity_) {
+            auto victim = queue_.end();
+
+            if (policy_ == OverflowPolicy::DropOldest) {
+                victim = queue_.begin();
+            } else if (policy_ == OverflowPolicy::ShedAutoTranslate) {
+                victim = std::find_if(queue_.begin(), queue_.end(), [](const Task& t) {
+                    return t.task_class == TaskClass::AutoTranslate;
+                });
+            }
+
+            ++dropped_;
+            tasks_dropped.add();
+            if (victim == queue_.end()) {
+                dropped_callback = std::move(incoming.on_drop);
+                accepted = false;
+            } else {
+                dropped_callback = std::move(victim->on_drop);
+                queue_.erase(victim);
+            }
+        }
+
+        if (accepted) {
+            queue_.push_back(std::move(incoming));
+            max_queue_depth_ = std::max(max_queue_depth_, queue_.size());
+        }
+    }
+
+    if (accepted) {
+        cv_.notify_one();
+    }
+    if (dropped_callback) {
+        dropped_callback();
+    }
+    return accepted;
+}
+
+WorkerPoolStats WorkerPool::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    WorkerPoolStats s;
+    s.queue_depth = queue_.size();
+    s.max_queue_depth = max_queue_depth_;
+    s.submitted = submitted_;
+    s.completed = completed_;
+    s.dropped = dropped_;
+    if (waited_tasks_ > 0) {
+        s.avg_wait_ms = std::chrono::duration<double, std::milli>(total_wait_).count() / waited_tasks_;
+    }
+    s.max_wait_ms = std::chrono::duration<double, std::milli>(max_wait_).count();
+
+    max_queue_depth_ = queue_.size();
+    waited_tasks_ = 0;
+    total_wait_ = std::chrono::nanoseconds(0);
+    max_wait_ = std::chrono::nanoseconds(0);
+    return s;
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkerPool::worker_loop() {
+    while (true) {
+        Task task;
+        std::chrono::steady_clock::duration waited;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+
+            // Slash commands jump the queue: they must answer within Discord's interaction deadline
+            auto next = std::find_if(queue_.begin(), queue_.end(), [](const Task& t) {
+                return t.task_class == TaskClass::Interactive;
+            });
+            if (next == queue_.end()) {
+                next = queue_.begin();
+            }
+            task = std::move(*next);
+            queue_.erase(next);
+
+            waited = std::chrono::steady_clock::now() - task.enqueued;
+            ++waited_tasks_;
+            total_wait_ += waited;
+            max_wait_ = std::max<std::chrono::nanoseconds>(max_wait_, waited);
+        }
+
+        (task.task_class == TaskClass::Interactive ? interactive_wait : auto_translate_wait).observe(waited);
+
+        try {
+            task.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Worker task error: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Worker task error: unknown exception" << std::endl;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++completed_;
+    }
+}
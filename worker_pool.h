@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Kind of work submitted to the pool
+enum class TaskClass {
+    Interactive,    // Slash command responses
+    AutoTranslate   // Background auto-translation of channel messages
+};
+
+// What to do when a task arrives and the queue is full
+enum class OverflowPolicy {
+    DropOldest,         // Evict the task that has waited longest
+    DropNewest,         // Reject the incoming task
+    ShedAutoTranslate   // Evict queued auto-translate work before slash commands
+};
+
+OverflowPolicy parse_overflow_policy(const std::string& name);
+
+struct WorkerPoolStats {
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t dropped = 0;
+    double avg_wait_ms = 0.0;
+    double max_wait_ms = 0.0;
+};
+
+// Fixed-size thread pool with a bounded task queue. Interactive tasks are
+// picked ahead of queued auto-translate work.
+class WorkerPool {
+public:
+    WorkerPool(size_t threads, size_t queue_capacity, OverflowPolicy policy);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Queue a task. on_drop runs instead of the task if it is ever shed, or
+    // right away if the pool is shutting down. Returns false if the incoming
+    // task itself was rejected.
+    bool submit(TaskClass task_class, std::function<void()> task, std::function<void()> on_drop = nullptr);
+
+    // Snapshot of the counters; wait statistics cover tasks started since the last call
+    WorkerPoolStats stats();
+
+    void shutdown();
+
+private:
+    struct Task {
+        TaskClass task_class;
+        std::function<void()> run;
+        std::function<void()> on_drop;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    void worker_loop();
+
+    const size_t queue_capacity_;
+    const OverflowPolicy policy_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+
+    size_t max_queue_depth_ = 0;
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t waited_tasks_ = 0;
+    std::chrono::nanoseconds total_wait_{0};
+    std::chrono::nanoseconds max_wait_{0};
+};